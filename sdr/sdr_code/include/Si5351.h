@@ -1,3 +1,14 @@
+#pragma once
+
 #include <ch32v30x.h>
 
-void Si5351_SetFrequency(float frequency);
+#define SI5351_XTAL_FREQ 25000000
+
+int Si5351_SetFrequency(u32 frequency);
+int Si5351_WriteRegister(u8 reg, u8 data);
+int Si5351_WriteBlock(u8 reg, const u8 *buf, u8 len);
+u8 Si5351_UpdateBlock(u8 reg, const u8 *buf, u8 len);
+int Si5351_BlockCached(u8 reg, const u8 *buf, u8 len);
+void Si5351_InvalidateCache(void);
+u8 Si5351_ReadRegister(u8 reg);
+int Si5351_Busy(void);
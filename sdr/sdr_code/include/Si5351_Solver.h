@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+	Exact rational solver for MS5351M quadrature settings.
+
+	f_out = f_clk * (a + b/c) / (N * 2^r_div), with the VCO kept in 600-900 MHz,
+	N even so that CLK1_PHOFF = N puts CLK1 90 degrees behind CLK0.
+*/
+
+#define SI5351_VCO_MIN      600000000
+#define SI5351_VCO_MAX      900000000
+#define SI5351_FREQ_MIN     2500
+#define SI5351_FREQ_MAX     200000000
+#define SI5351_C_MAX        1048575     // 20 bit PLL denominator
+#define SI5351_N_MAX        2048        // largest Multisynth output divider
+#define SI5351_PHOFF_MAX    127         // CLKx_PHOFF is 7 bits wide
+
+typedef struct {
+	uint32_t a;         // PLLA feedback integer part (15..90)
+	uint32_t b;         // PLLA feedback numerator, b < c
+	uint32_t c;         // PLLA feedback denominator (1..SI5351_C_MAX)
+	uint16_t N;         // even integer Multisynth divider (4, 6, 8 ... SI5351_N_MAX)
+	uint8_t  r_div;     // R output divider as a power of two (0..7)
+	uint8_t  phoff;     // CLK1_PHOFF for quadrature, 0 when quadrature is impossible
+	int32_t  error_mhz; // synthesized minus requested frequency, millihertz
+} si5351_params_t;
+
+int Si5351_Solve(uint32_t f_clk, uint32_t frequency, si5351_params_t *params);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <ch32v30x.h>
+
+/*
+	Receive front end: ADC_I (PA1, ADC1) and ADC_Q (PA2, ADC2) sampled together in
+	dual regular-simultaneous mode, paced by TIM3. DMA1 channel 1 moves each pair as
+	one word (I in bits 11:0, Q in bits 27:16) into a circular buffer; the half-
+	transfer and transfer-complete interrupts hand each finished half to a callback.
+*/
+
+#define ADC_IQ_CLOCK    12000000                // PCLK2 / 12, inside the ADC's 14 MHz limit
+#define ADC_IQ_MAX_RATE (ADC_IQ_CLOCK / 14)     // 1.5 + 12.5 clocks per conversion: 857 kHz
+
+typedef void (*adc_iq_callback_t)(u32 *samples, u16 count, void *context);
+
+u32 ADC_IQ_Start(u32 sample_rate, u32 *buffer, u16 length, adc_iq_callback_t callback, void *context);
+void ADC_IQ_Stop(void);
+u32 ADC_IQ_Blocks(void);
+
+/* Convert n packed pairs to interleaved Q15 I/Q around mid-scale; iq may alias samples */
+static inline void ADC_IQ_Unpack(const u32 *samples, int16_t *iq, u16 n) {
+	for (u16 k = 0; k < n; k++) {
+		iq[2 * k] = (int16_t)(((int32_t)(samples[k] & 0xFFF) - 2048) << 4);
+		iq[2 * k + 1] = (int16_t)(((int32_t)((samples[k] >> 16) & 0xFFF) - 2048) << 4);
+	}
+}
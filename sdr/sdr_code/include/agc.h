@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+	Block AGC with attack, hang and decay, worked in the log domain.
+
+	Each block's peak envelope (|x|, or alpha-max-plus-beta-min for I/Q) is turned
+	into a Q8 log2 level; the wanted gain is target - level. A drop in wanted gain
+	is followed with the attack time constant, then held for the hang time before
+	gain recovers at the decay rate. The log gain is converted back through a
+	small 2^x table and ramped linearly across the block so there is no zipper
+	noise at block edges.
+
+	Levels are in Q8 log2 units: 256 = one octave = 6.02 dB.
+*/
+
+typedef struct {
+	int32_t gain_log;       // current gain, Q8 log2
+	int32_t target_log;     // wanted peak output, Q8 log2 of a Q15 magnitude
+	int32_t max_gain_log;
+	int32_t attack;         // Q15 share of a gain drop taken per block
+	int32_t decay_step;     // Q8 log2 gain rise per block after hang
+	uint16_t hang_blocks;
+	uint16_t hang;          // blocks left before decay starts
+	uint32_t gain_lin;      // Q16 linear gain reached at the end of the last block
+} agc_t;
+
+void agc_init(agc_t *agc, uint32_t sample_rate, uint16_t block_len, int16_t target,
+              uint8_t max_gain_db, uint16_t attack_ms, uint16_t decay_db_per_s, uint16_t hang_ms);
+void agc_process(agc_t *agc, int16_t *x, uint16_t n);
+void agc_process_iq(agc_t *agc, int16_t *iq, uint16_t n);
+
+/* Current gain in tenths of a dB, for display */
+int16_t agc_gain_db10(const agc_t *agc);
+
+int32_t agc_log2_q8(uint32_t x);
+uint32_t agc_exp2_q16(int32_t x);
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <ch32v30x.h>
+
+/*
+	Demodulated audio to the LM4871 via DAC_I (the amplifier input is wired to
+	DAC channel 1; DAC_Q is held at mid-scale).
+
+	The demodulator writes Q15 samples at its own rate into a ring buffer. The DAC
+	stream pulls them at AUDIO_RATE through a linear-interpolating resampler whose
+	ratio is trimmed from the ring fill level, so small clock differences between
+	the ADC and DAC timers neither empty nor overflow the ring. The amplifier is
+	switched off after AUDIO_GATE_MS of silence and back on at the first sound.
+
+	Worst case latency is AUDIO_RING_SIZE source samples plus one DAC buffer;
+	Audio_Latency_Us() reports the current figure from the averaged fill.
+*/
+
+#define AUDIO_RATE          24000   // DAC sample rate (TIM8: 144 MHz / 6000)
+#define AUDIO_RING_SIZE      512    // source samples, power of two
+#define AUDIO_DAC_LENGTH     128    // DAC words, two halves
+#define AUDIO_SILENCE         64    // Q15 peak below which a DAC block is silent
+#define AUDIO_GATE_MS        500
+
+void Audio_Start(u32 source_rate);
+void Audio_Stop(void);
+u16 Audio_Write(const int16_t *samples, u16 n);
+
+u32 Audio_Latency_Us(void);
+u32 Audio_Underruns(void);
+u32 Audio_Overruns(void);
+u8 Audio_Amplifier_On(void);
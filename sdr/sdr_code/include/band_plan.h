@@ -0,0 +1,23 @@
+#pragma once
+
+#include <ch32v30x.h>
+
+/*
+	One amateur band of the quadrature band plan (see src/Quadrature_Synthesis.ipynb).
+
+	Within a band the output divider N, PLLA integer part a and denominator c are fixed,
+	so retuning only needs b. The table itself is produced by scripts/gen_band_plan.py.
+*/
+typedef struct {
+	u32 f_low;          // lowest frequency in the band (Hz)
+	u32 f_high;         // highest frequency in the band (Hz)
+	u16 N;              // even integer output divider for CLK0 and CLK1
+	u8  phoff;          // CLK1_PHOFF for 90 degrees, 0 if N does not fit in 7 bits
+	u8  a;              // PLLA feedback integer part
+	u32 c;              // PLLA feedback denominator
+	u32 c_per_hz_q32;   // c / f_clk in 0.32 fixed point, turns a VCO offset (Hz) into b
+	u8  ms[8];          // MS0/MS1 parameter registers (42-49 and 50-57)
+} band_plan_t;
+
+extern const band_plan_t BAND_PLAN[];
+extern const u8 BAND_PLAN_COUNT;
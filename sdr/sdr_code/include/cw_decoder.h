@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+#include "spsc_ring.h"
+
+/*
+	Morse decoder for demodulated audio.
+
+	A bank of Goertzel filters around the CW pitch measures tone power every
+	CW_BLOCK samples; the strongest bin is used, so the decoder tolerates being
+	a little off tune. The power is keyed against an adaptive threshold halfway
+	(in log terms) between tracked mark and space levels. Mark and space lengths
+	in blocks are classified against a running dot length estimate, and the
+	dots and dashes of a character index a binary tree lookup table.
+
+	Decoded characters (and ' ' between words) queue up for cw_decoder_getc().
+*/
+
+#define CW_BINS          5      // pitch - 2 * spacing .. pitch + 2 * spacing
+#define CW_BIN_SPACING 100      // Hz
+#define CW_BLOCK        64      // samples per decision, 5.3 ms at 12 kHz
+#define CW_TEXT_SIZE    32      // power of two
+
+typedef struct {
+	float coeff[CW_BINS];       // 2 cos(w) per bin
+	float s1[CW_BINS], s2[CW_BINS];
+	uint16_t count;             // samples into the current block
+
+	float mark_level, space_level;
+	uint8_t key;                // current keyed state
+	uint16_t run;               // blocks in the current state
+	uint16_t dot;               // dot length estimate, blocks, Q4
+	uint8_t code;               // binary tree index, 1 = empty
+	uint8_t word_pending;       // a word gap is due after the next character
+
+	char text[CW_TEXT_SIZE];
+	spsc_ring_t text_ring;      // the decoder produces, cw_decoder_getc consumes
+} cw_decoder_t;
+
+void cw_decoder_init(cw_decoder_t *cw, uint32_t sample_rate, uint32_t pitch_hz);
+void cw_decoder_process(cw_decoder_t *cw, const int16_t *audio, uint16_t n);
+char cw_decoder_getc(cw_decoder_t *cw);
+
+/* Speed estimate from the dot length */
+uint8_t cw_decoder_wpm(const cw_decoder_t *cw, uint32_t sample_rate);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <ch32v30x.h>
+
+/*
+	Ping-pong I/Q baseband streaming on DMA2 channel 3 (dual DAC, TIM8 paced).
+
+	The buffer is played in a loop. When DMA finishes one half (half-transfer or
+	transfer-complete interrupt) that half is handed back to the producer, which
+	must refill it before DMA wraps around to it again. Either:
+	  - pass a fill callback, which runs in the DMA interrupt, or
+	  - pass 0 and poll DAC_Stream_Acquire() / DAC_Stream_Release() from the main loop.
+	A half that is not released in time is replayed and counted as an underrun;
+	in fill mode a fill still running when DMA finishes the other half counts too.
+*/
+
+typedef void (*dac_stream_fill_t)(u32 *samples, u16 count, void *context);
+
+void DAC_Stream_Start(u32 *buffer, u16 length, dac_stream_fill_t fill, void *context);
+void DAC_Stream_Stop(void);
+
+u32 *DAC_Stream_Acquire(void);
+void DAC_Stream_Release(u32 *half);
+u16 DAC_Stream_HalfLength(void);
+
+u32 DAC_Stream_Blocks(void);
+u32 DAC_Stream_Underruns(void);
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+	Multi-stage I/Q decimator: CIC -> half-band FIRs -> channel FIR.
+
+	Every stage takes interleaved Q15 I/Q pairs and writes its (shorter) output
+	back over the start of the same buffer, returning the number of output pairs,
+	so a whole DMA half can be reduced in place. Filter history is kept in the
+	stage state and carries across blocks of any length.
+
+	The CIC does the heavy lifting at the ADC rate with adds only. Its gain is
+	rate^order, removed by a shift, so keep 16 + order * log2(rate) <= 32 bits and
+	prefer a power of two rate for unity gain.
+*/
+
+#define CIC_MAX_ORDER          5
+#define FIR_MAX_TAPS          63
+#define DECIMATE_MAX_HALFBANDS 3
+
+typedef struct {
+	uint32_t integ[2][CIC_MAX_ORDER];   // integrators, wrap modulo 2^32
+	uint32_t comb[2][CIC_MAX_ORDER];    // previous comb inputs
+	uint8_t order;
+	uint8_t shift;                      // ceil(order * log2(rate))
+	uint16_t rate;
+	uint16_t count;                     // inputs since the last output
+} cic_t;
+
+typedef struct {
+	const int16_t *taps;    // odd taps h1, h3, ... either side of the 1/2 centre
+	uint8_t per_side;
+	uint8_t len;            // 4 * per_side - 1
+	uint8_t pos;
+	uint8_t phase;
+	int16_t delay[2][2 * FIR_MAX_TAPS];
+} halfband_t;
+
+typedef struct {
+	const int16_t *taps;    // symmetric Q15, sum 32768 for unity gain
+	uint8_t len;
+	uint8_t decim;
+	uint8_t pos;
+	uint8_t phase;
+	int16_t delay[2][2 * FIR_MAX_TAPS];
+} fir_t;
+
+typedef struct {
+	cic_t cic;
+	halfband_t hb[DECIMATE_MAX_HALFBANDS];
+	uint8_t halfbands;
+	fir_t fir;
+} decimator_t;
+
+/* Tables from scripts/gen_decimate_taps.py (768 kHz / 16 / 2 / 2 = 12 kHz) */
+#define DECIMATE_DEFAULT_CIC_ORDER  4
+#define DECIMATE_DEFAULT_CIC_RATE  16
+#define DECIMATE_DEFAULT_HALFBANDS  2
+#define HALFBAND_SHORT_PER_SIDE     3
+#define HALFBAND_LONG_PER_SIDE      6
+#define DECIMATE_COMP_LEN          31
+
+extern const int16_t HALFBAND_SHORT[HALFBAND_SHORT_PER_SIDE];
+extern const int16_t HALFBAND_LONG[HALFBAND_LONG_PER_SIDE];
+extern const int16_t DECIMATE_COMP_TAPS[DECIMATE_COMP_LEN];
+
+void cic_init(cic_t *cic, uint8_t order, uint16_t rate);
+uint16_t cic_process(cic_t *cic, int16_t *iq, uint16_t n);
+
+void halfband_init(halfband_t *hb, const int16_t *taps, uint8_t per_side);
+uint16_t halfband_process(halfband_t *hb, int16_t *iq, uint16_t n);
+
+void fir_init(fir_t *fir, const int16_t *taps, uint8_t len, uint8_t decim);
+uint16_t fir_process(fir_t *fir, int16_t *iq, uint16_t n);
+
+/* Short half-bands first, the long one last where the transition is sharpest */
+void decimator_init(decimator_t *d, uint8_t cic_order, uint16_t cic_rate, uint8_t halfbands,
+                    const int16_t *fir_taps, uint8_t fir_len, uint8_t fir_decim);
+void decimator_init_default(decimator_t *d);
+uint16_t decimator_process(decimator_t *d, int16_t *iq, uint16_t n);
+uint32_t decimator_ratio(const decimator_t *d);
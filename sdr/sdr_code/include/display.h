@@ -0,0 +1,29 @@
+// ===================================================================================
+// Partial OLED refresh on top of the u8g2 full frame buffer
+// ===================================================================================
+//
+// Display_Flush() replaces u8g2_SendBuffer(): it compares the frame buffer with the
+// frame last sent, one 8x8 tile at a time, and only transmits runs of changed tiles.
+//
+// The frame buffer mirrors the panel RAM. Display_Set_Start_Line() rotates which RAM
+// row is shown at the top of the screen (SSD1306 command 0x40 | line), so a view can
+// scroll without rewriting the rows that only moved; the flush sends it when changed.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <u8g2.h>
+
+#define DISPLAY_TILE_COLS 16      // 128 pixels / 8
+#define DISPLAY_TILE_ROWS 8       // 64 pixels / 8
+
+uint8_t Display_Flush(u8g2_t *u8g2);  // send changed tiles, returns how many were sent
+void Display_Invalidate(void);        // next flush sends everything (display written elsewhere)
+void Display_Set_Start_Line(uint8_t line);  // RAM row at the top of the screen, 0-63
+
+#ifdef __cplusplus
+};
+#endif
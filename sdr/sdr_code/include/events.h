@@ -0,0 +1,38 @@
+#pragma once
+
+#include <ch32v30x.h>
+
+/*
+	Main loop events.
+
+	Interrupt handlers post events by setting a bit in a pending word with an
+	atomic OR, so any handler at any priority can post without a critical
+	section. Event_Wait() sleeps in WFI until something is pending, then hands
+	the whole set to the main loop and clears it. Repeated posts of the same
+	event before the main loop runs coalesce; data that must not be lost
+	travels in its own queue and the event only says "look at it".
+
+	TIM4 provides a 1 ms tick for Event_Millis(), key sampling and a few
+	software timers that post EVENT_TIMER_0 + n when they expire.
+*/
+
+#define EVENT_TIMERS 4
+
+enum EVENT {
+	EVENT_KEY = 0,          // key events waiting in Keys_Get()
+	EVENT_DISPLAY_DONE,     // OLED I2C queue has drained
+	EVENT_SPECTRUM,         // RX spectrum block ready
+	EVENT_CW_TEXT,          // decoded CW characters waiting
+	EVENT_TIMER_0,
+	EVENT_COUNT = EVENT_TIMER_0 + EVENT_TIMERS
+};
+
+#define EVENT_BIT(event) (1u << (event))
+
+void Event_Init(void);
+void Event_Post(u8 event);
+u32 Event_Wait(void);
+
+void Event_Timer_Start(u8 timer, u16 period_ms);
+void Event_Timer_Stop(u8 timer);
+u32 Event_Millis(void);
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+	In-place fixed-point complex FFT on interleaved Q15 I/Q.
+
+	Decimation in time: the input is bit-reverse permuted, then pairs of radix-2
+	stages are done as radix-4 butterflies (three twiddle multiplies instead of
+	four), with one radix-2 stage first when log2(n) is odd. Each stage scales by
+	its radix, so the output is X[k] / n and cannot overflow. Twiddles come from
+	the NCO sine table, exact for n up to 1024.
+*/
+
+#define FFT_MAX_N 256
+
+void fft_q15(int16_t *iq, uint16_t n);
+
+/* Hann window in place; n a power of two */
+void fft_window_hann(int16_t *iq, uint16_t n);
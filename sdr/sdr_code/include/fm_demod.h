@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+	Block FM discriminator for interleaved Q15 I/Q.
+
+	Each sample is multiplied by the conjugate of the previous one; the angle of
+	the product is the phase step, found with an octant-reduced polynomial atan2
+	(max error about 0.1 degree). Output is scaled so the configured deviation is
+	full scale, then passed through a one-pole de-emphasis filter.
+*/
+
+typedef struct {
+	int16_t prev_i, prev_q;     // last input sample, carried across blocks
+	int32_t gain;               // Q8, phase step -> audio
+	int32_t alpha;              // Q15 de-emphasis coefficient, 32768 = off
+	int32_t deemph;             // de-emphasis state, Q15 << 15
+	uint32_t cycles_per_sample; // measured on the last block (RISC-V only)
+} fm_demod_t;
+
+void fm_demod_init(fm_demod_t *fm, uint32_t sample_rate, uint32_t deviation_hz, uint32_t deemph_us);
+void fm_demod_process(fm_demod_t *fm, const int16_t *iq, int16_t *audio, uint16_t n);
+
+/* Angle of (x, y), 32768 = pi, so the result wraps like a phase */
+int16_t fm_atan2(int32_t y, int32_t x);
@@ -12,9 +12,14 @@
 #define DAC_Q_PIN GPIO_Pin_5
 #define AUDIO_SHUTDOWN_PIN GPIO_Pin_6
 
+#define ADC_I_PIN GPIO_Pin_1
+#define ADC_Q_PIN GPIO_Pin_2
+
 #define DAC_I_PORT GPIOA
 #define DAC_Q_PORT GPIOA
 #define AUDIO_SHUTDOWN_PORT GPIOA
+#define ADC_I_PORT GPIOA
+#define ADC_Q_PORT GPIOA
 
 
 #define PTT_KEY_PIN GPIO_Pin_8
@@ -23,12 +28,24 @@
 #define MODE_KEY_PIN GPIO_Pin_9
 #define MODE_KEY_PORT GPIOB
 
+/*
+ * The schematic's KEY net is PB9, used as MODE above. Its LEFT and RIGHT nets are
+ * headphone channels, not buttons: define LEFT_KEY_PIN/PORT and RIGHT_KEY_PIN/PORT
+ * (active low) here if buttons are fitted and keys.c will scan them.
+ */
+
 
 void GPIO_Pins_Init(void);
 void DAC_Initialize(void);
 void DAC_Timer_Init(u16 arr,u16 psc);
 
 void DAC_DMA_Init(u16* dacbuff16bit_ptr, u32 buffsize);
+
+/* Dual channel baseband: I in bits 11:0, Q in bits 27:16 of RD12BDHR */
+#define DAC_IQ(i, q) ((((u32)(q) & 0xFFF) << 16) | ((u32)(i) & 0xFFF))
+
+void DAC_Dual_Initialize(void);
+void DAC_Dual_DMA_Init(u32* iqbuff32bit_ptr, u32 buffsize);
 void Synthesizer_Init(u32 bound, u16 address);
 
 int PTT_Pressed(void);
@@ -0,0 +1,36 @@
+// ===================================================================================
+// Interrupt driven I2C1 master with a transaction queue
+// ===================================================================================
+//
+// Transactions are copied into a fixed ring of descriptors and run back to back from
+// the I2C1 event/error interrupts, so callers never wait on the bus unless the queue
+// is full or they explicitly flush it.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ch32v30x.h>
+
+#define I2C1_QUEUE_LEN       16     // descriptors in the ring, power of two
+#define I2C1_QUEUE_DATA_MAX  16     // largest write payload (one MS0+MS1 burst)
+
+// Transaction status passed to completion callbacks
+#define I2C1_OK         0
+#define I2C1_NACK       1           // slave did not acknowledge
+#define I2C1_BUS_ERROR  2           // bus error, arbitration lost or overrun
+
+typedef void (*i2c1_callback_t)(u8 status, void *context);
+
+void I2C1_Queue_Init(void);
+int  I2C1_Queue_Write(u8 address, u8 reg, const u8 *buf, u8 len, i2c1_callback_t callback, void *context);
+int  I2C1_Queue_Read(u8 address, u8 reg, u8 *dest, u8 len, i2c1_callback_t callback, void *context);
+int  I2C1_Queue_Idle(void);
+void I2C1_Queue_Flush(void);
+u32  I2C1_Queue_Errors(void);
+
+#ifdef __cplusplus
+};
+#endif
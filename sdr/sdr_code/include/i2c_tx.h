@@ -19,6 +19,11 @@ extern "C" {
 #define OLED_I2C_PORT I2C2
 #define OLED_I2C_SCL_PIN GPIO_Pin_10
 #define OLED_I2C_SDA_PIN GPIO_Pin_11
+#define OLED_I2C_DMA       DMA1_Channel4  // I2C2_TX request
+
+// Background transfer queue, big enough for one full 128x64 frame from u8g2
+#define OLED_I2C_POOL      1536      // bytes of queued payload
+#define OLED_I2C_SEGMENTS  64        // queued transactions, power of two
 
 // I2C Functions
 void OLED_I2C_init(void);            // I2C init function
@@ -26,6 +31,12 @@ void OLED_I2C_start(uint8_t addr);   // I2C start transmission, addr must contai
 void OLED_I2C_write(uint8_t data);   // I2C transmit one data byte via I2C
 void OLED_I2C_stop(void);            // I2C stop transmission
 
+// Background (DMA) Functions
+void OLED_I2C_DMA_init(void);                                     // DMA and interrupt init
+void OLED_I2C_send(uint8_t addr, const uint8_t *buf, uint16_t len); // queue one transaction
+int  OLED_I2C_busy(void);            // display transfer still in progress
+void OLED_I2C_wait(void);            // wait until the queue is empty
+
 
 #ifdef __cplusplus
 };
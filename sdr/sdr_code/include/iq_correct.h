@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+	Streaming DC offset and I/Q imbalance correction for interleaved Q15 I/Q.
+
+	A leaky integrator per channel tracks and removes the DC offset. The
+	second moments <II>, <QQ>, <IQ> of the DC-free signal are averaged across
+	blocks; once per block they give a 2x2 correction (Gram-Schmidt) that
+	removes the part of Q correlated with I and rescales Q to match I's power:
+
+		I' = I
+		Q' = c_qi * I + c_qq * Q
+
+	Per sample this costs two subtracts for DC, three multiplies for the
+	statistics and two for the correction. Run it after decimation.
+*/
+
+typedef struct {
+	int32_t dc_i, dc_q;     // DC estimate, Q15 << 16
+	uint8_t dc_shift;       // DC time constant: 2^dc_shift samples
+	float ii, qq, iq;       // averaged second moments
+	float mu;               // per-block averaging weight
+	int16_t c_qi, c_qq;     // Q14 correction coefficients
+} iq_correct_t;
+
+void iq_correct_init(iq_correct_t *c, uint8_t dc_shift, uint8_t adapt_shift);
+void iq_correct_process(iq_correct_t *c, int16_t *iq, uint16_t n);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <ch32v30x.h>
+
+/*
+	Debounced keys.
+
+	Every key is sampled from the 1 kHz event tick into an integrator that counts
+	up while the contact reads pressed and down while it reads released; the
+	debounced state only changes when the count reaches KEY_DEBOUNCE_MS or 0, so
+	bounce shorter than that never gets through. Press, release and long-press
+	events go into a queue read with Keys_Get(), and EVENT_KEY is posted.
+*/
+
+#define KEY_DEBOUNCE_MS   5
+#define KEY_LONG_MS     700
+#define KEY_QUEUE_SIZE   16     // power of two
+
+enum KEY_ID {
+	KEY_MODE = 0,               // PB9, the schematic's KEY
+	KEY_PTT,                    // PC8
+	KEY_LEFT,                   // optional, see hardware.h
+	KEY_RIGHT,                  // optional, see hardware.h
+	KEY_COUNT
+};
+
+enum KEY_ACTION {
+	KEY_PRESS = 0,
+	KEY_RELEASE,
+	KEY_LONG_PRESS              // held KEY_LONG_MS; a release still follows
+};
+
+typedef struct {
+	u8 key;
+	u8 action;
+} key_event_t;
+
+void Keys_Init(void);
+void Keys_Sample(void);
+int Keys_Get(key_event_t *event);
+u8 Keys_Down(u8 key);
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+	Numerically controlled oscillator.
+
+	A 32 bit phase accumulator advanced by a fixed step per sample; the top bits
+	index a quarter-wave Q15 sine table shared by every oscillator. Resolution is
+	sample_rate / 2^32 (about 25 uHz at 100 kHz). No state besides nco_t.
+*/
+
+#define NCO_QUARTER_BITS 8                  // 256 table steps per quarter wave
+#define NCO_QUARTER      (1 << NCO_QUARTER_BITS)
+
+typedef struct {
+	uint32_t phase;         // current phase, 2^32 = one cycle
+	uint32_t step;          // phase increment per sample
+	uint8_t interpolate;    // 1: linear interpolation between table entries
+} nco_t;
+
+void nco_init(nco_t *nco, int32_t freq_mhz, uint32_t sample_rate, uint8_t interpolate);
+void nco_set_frequency(nco_t *nco, int32_t freq_mhz, uint32_t sample_rate);
+uint32_t nco_step(int32_t freq_mhz, uint32_t sample_rate);
+
+int16_t nco_sin(uint32_t phase);
+int16_t nco_sin_interp(uint32_t phase);
+
+static inline int16_t nco_cos(uint32_t phase) {
+	return nco_sin(phase + 0x40000000u);
+}
+
+static inline int16_t nco_cos_interp(uint32_t phase) {
+	return nco_sin_interp(phase + 0x40000000u);
+}
+
+void nco_fill(nco_t *nco, int16_t *buf, uint16_t n);
+void nco_fill_iq(nco_t *nco, int16_t *buf, uint16_t n);
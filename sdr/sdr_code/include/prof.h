@@ -0,0 +1,66 @@
+#pragma once
+
+#include <ch32v30x.h>
+
+/*
+	Cycle-count probes.
+
+		PROF_BEGIN(PROF_RX_PROCESS);
+		...
+		PROF_END(PROF_RX_PROCESS);
+
+	Each probe keeps count, min, max and total mcycle counts plus a histogram
+	with one bucket per power of two, so bucket k holds the runs that took
+	2^k .. 2^(k+1)-1 cycles (1 us is 144 cycles). PROF_BEGIN declares a local
+	start time, so the pair must sit in the same block.
+
+	Build with -DPROFILE (the "profile" environment in platformio.ini) to
+	enable them; otherwise the probes and Prof_* calls compile to nothing.
+	Prof_Dump() prints the table on the debug UART at PROF_BAUD.
+
+	A probe must only ever run in one context (the main loop or one interrupt
+	handler) so its entry is not updated from two places at once. The dump
+	reads entries that interrupts may be updating, so a line can be off by the
+	one run in flight.
+*/
+
+#define PROF_BAUD    115200
+#define PROF_BUCKETS 24         // last bucket also holds anything slower, 2^23 cycles = 58 ms
+
+enum PROF_ID {
+	PROF_RX_PROCESS = 0,        // ADC DMA interrupt: decimate, demodulate, AGC
+	PROF_AUDIO_FILL,            // DAC DMA interrupt: resample into the DAC buffer
+	PROF_DISPLAY_FLUSH,         // main loop Display_Update
+	PROF_SEND_BUFFER,           // u8g2_SendBuffer, full frame into the I2C queue
+	PROF_WATERFALL,             // spectrum and waterfall drawing
+	PROF_GAME_LOOP,             // one tiny_invaders_loop frame
+	PROF_UPDATE_DISPLAY,        // the game's UpdateDisplay, drawing only
+	PROF_SI5351_SET_FREQUENCY,
+	PROF_COUNT
+};
+
+#ifdef PROFILE
+
+static inline u32 Prof_Cycles(void) {
+	u32 c;
+	__asm__ volatile ("csrr %0, mcycle" : "=r"(c));
+	return c;
+}
+
+#define PROF_BEGIN(id) u32 prof_start_##id = Prof_Cycles()
+#define PROF_END(id)   Prof_Record((id), Prof_Cycles() - prof_start_##id)
+
+void Prof_Init(void);
+void Prof_Reset(void);
+void Prof_Record(u8 id, u32 cycles);
+void Prof_Dump(void);
+
+#else
+
+#define PROF_BEGIN(id) ((void)0)
+#define PROF_END(id)   ((void)0)
+#define Prof_Init()    ((void)0)
+#define Prof_Reset()   ((void)0)
+#define Prof_Dump()    ((void)0)
+
+#endif
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <ch32v30x.h>
+
+/*
+	Receive chain, run from the ADC DMA interrupt on each captured half:
+
+	ADC_I/ADC_Q 768 kHz -> decimator (CIC, half-bands, channel FIR) -> 12 kHz
+	-> DC / I/Q imbalance correction -> demodulator -> AGC -> audio ring -> DAC
+
+	The demodulator is Weaver SSB/CW (160 m - 10 m) or FM (6 m, 2 m).
+*/
+
+#define RX_ADC_RATE    768000
+#define RX_ADC_HALF      1024   // pairs per DMA half, 1.33 ms
+#define RX_AUDIO_RATE   12000
+#define RX_SPECTRUM_N     256   // corrected 12 kHz I/Q pairs per spectrum block
+#define RX_BLOCK       (RX_ADC_HALF * RX_AUDIO_RATE / RX_ADC_RATE)   // 12 kHz pairs per half
+
+/* Block settings, shared with the golden-vector tests so they follow any retune */
+#define RX_IQ_DC_SHIFT     10   // DC blocker time constant, 2^n samples
+#define RX_IQ_ADAPT_SHIFT   4   // imbalance estimate averages 2^n blocks
+#define RX_FM_DEVIATION  2500   // Hz at full-scale audio
+#define RX_FM_DEEMPH_US   750
+
+enum RX_MODE {
+	RX_MODE_USB = 0,
+	RX_MODE_LSB,
+	RX_MODE_CW,
+	RX_MODE_FM,
+	RX_MODE_COUNT
+};
+
+void RX_Start(void);
+void RX_Stop(void);
+void RX_Set_Mode(u8 mode);
+u8 RX_Mode(void);
+
+/* Next character from the CW decoder (RX_MODE_CW only), 0 if none */
+char RX_CW_Getc(void);
+
+/* Ask for the next RX_SPECTRUM_N pairs; RX_Spectrum_Block() returns them once complete */
+void RX_Spectrum_Request(void);
+int16_t *RX_Spectrum_Block(void);
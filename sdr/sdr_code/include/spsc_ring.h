@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+	Lock-free single-producer / single-consumer ring indices.
+
+	The ring only manages indices; the slots are an array of any type owned by
+	the user, with a power-of-two capacity. One side (an interrupt handler, say)
+	only ever produces and the other only consumes, so neither needs to mask
+	interrupts:
+
+		producer                            consumer
+		n = spsc_write_span(&r, &i);        n = spsc_read_span(&r, &i);
+		fill slots[i .. i+n-1]              use slots[i .. i+n-1]
+		spsc_commit(&r, n);                 spsc_release(&r, n);
+
+	Spans are contiguous (they stop at the end of the array), so a DMA transfer
+	or memcpy can work on them directly; call again after a commit/release to
+	get the part that wrapped. head and tail are free-running counters, so the
+	ring can hold all capacity slots.
+
+	Publishing uses release stores and reading the other side's index acquire
+	loads. On RV32 with the A extension GCC maps these to "fence rw,w" before
+	the store and "fence r,rw" after the load; on a single core this only keeps
+	the compiler and write buffer in order and costs a cycle or two.
+*/
+
+typedef struct {
+	uint32_t head;          // slots written, only stored by the producer
+	uint32_t tail;          // slots read, only stored by the consumer
+	uint32_t mask;          // capacity - 1
+} spsc_ring_t;
+
+/* capacity must be a power of two */
+static inline void spsc_init(spsc_ring_t *r, uint32_t capacity) {
+	r->head = 0;
+	r->tail = 0;
+	r->mask = capacity - 1;
+}
+
+static inline uint32_t spsc_capacity(const spsc_ring_t *r) {
+	return r->mask + 1;
+}
+
+/* Filled slots; exact for the consumer, a lower bound for the producer */
+static inline uint32_t spsc_count(const spsc_ring_t *r) {
+	return __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+}
+
+/* Free slots; exact for the producer, a lower bound for the consumer */
+static inline uint32_t spsc_space(const spsc_ring_t *r) {
+	return spsc_capacity(r) - spsc_count(r);
+}
+
+/* Producer: contiguous free slots starting at *index */
+static inline uint32_t spsc_write_span(const spsc_ring_t *r, uint32_t *index) {
+	uint32_t head = r->head;
+	uint32_t free = spsc_capacity(r) - (head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE));
+	uint32_t to_end = spsc_capacity(r) - (head & r->mask);
+
+	*index = head & r->mask;
+	return free < to_end ? free : to_end;
+}
+
+/* Producer: publish n slots filled since the last commit */
+static inline void spsc_commit(spsc_ring_t *r, uint32_t n) {
+	__atomic_store_n(&r->head, r->head + n, __ATOMIC_RELEASE);
+}
+
+/* Consumer: contiguous filled slots starting at *index */
+static inline uint32_t spsc_read_span(const spsc_ring_t *r, uint32_t *index) {
+	uint32_t tail = r->tail;
+	uint32_t used = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) - tail;
+	uint32_t to_end = spsc_capacity(r) - (tail & r->mask);
+
+	*index = tail & r->mask;
+	return used < to_end ? used : to_end;
+}
+
+/* Consumer: hand n slots back to the producer */
+static inline void spsc_release(spsc_ring_t *r, uint32_t n) {
+	__atomic_store_n(&r->tail, r->tail + n, __ATOMIC_RELEASE);
+}
+
+/* Single slot helpers: index of the slot to fill / read, or -1 if full / empty */
+static inline int32_t spsc_push_index(const spsc_ring_t *r) {
+	uint32_t index;
+	return spsc_write_span(r, &index) ? (int32_t)index : -1;
+}
+
+static inline int32_t spsc_pop_index(const spsc_ring_t *r) {
+	uint32_t index;
+	return spsc_read_span(r, &index) ? (int32_t)index : -1;
+}
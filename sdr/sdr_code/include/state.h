@@ -3,5 +3,6 @@ enum STATE {
 	STATE_IDLE = 0,
 	STATE_SENDING,
 	STATE_RECEIVING,
+	STATE_SPECTRUM,
 	STATE_GAME
 };
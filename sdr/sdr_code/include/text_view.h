@@ -0,0 +1,26 @@
+// ===================================================================================
+// Scrolling text lines at the bottom of the display
+// ===================================================================================
+//
+// Characters are appended to the last line; a full line or '\n' scrolls the lines
+// up by one. Text_View_Draw() repaints only the text area of the frame buffer.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <u8g2.h>
+
+#define TEXT_VIEW_LINES   3
+#define TEXT_VIEW_COLS   21       // 128 pixels / 6 pixel font
+#define TEXT_VIEW_TOP    33       // first pixel row of the text area
+
+void Text_View_Clear(void);
+void Text_View_Putc(char c);
+void Text_View_Draw(u8g2_t *u8g2);
+
+#ifdef __cplusplus
+};
+#endif
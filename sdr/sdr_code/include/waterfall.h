@@ -0,0 +1,26 @@
+// ===================================================================================
+// Spectrum and waterfall view of the receiver baseband
+// ===================================================================================
+//
+// The top 16 rows show the averaged spectrum as bars, the 48 rows below a waterfall
+// that scrolls down one pixel per frame. The panel does the scrolling (display start
+// line), so only the spectrum and the new waterfall row change in the frame buffer
+// and Display_Flush() sends 3 of the 8 pages.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <u8g2.h>
+
+#define WATERFALL_FFT_N    256     // I/Q pairs per frame
+#define WATERFALL_RANGE_DB  40     // from the noise floor to a full bar
+
+void Waterfall_Init(u8g2_t *u8g2);
+void Waterfall_Update(u8g2_t *u8g2, int16_t *iq);  // iq: WATERFALL_FFT_N pairs, overwritten
+
+#ifdef __cplusplus
+};
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+#include "decimate.h"
+#include "nco.h"
+
+/*
+	Weaver SSB/CW demodulator for zero-IF I/Q.
+
+	The centre of the wanted passband (+1500 Hz for USB, -1500 Hz for LSB, the
+	sidetone pitch for CW) is mixed to 0 Hz with an NCO, I and Q are low-pass
+	filtered by the same real FIR, and the result is mixed back up and its real
+	part taken. The unwanted sideband falls outside the low-pass and is rejected
+	by the filter alone; no Hilbert transform is needed. The same oscillator
+	samples are used for both mixers.
+*/
+
+#define WEAVER_USB_CENTRE_MHZ   1500000
+#define WEAVER_CW_PITCH_MHZ      700000
+#define WEAVER_TAPS                   63
+#define WEAVER_MAX_BLOCK              64
+
+typedef struct {
+	nco_t nco;
+	fir_t lpf;
+} weaver_t;
+
+extern const int16_t WEAVER_SSB_TAPS[WEAVER_TAPS];
+extern const int16_t WEAVER_CW_TAPS[WEAVER_TAPS];
+
+/* centre_mhz: passband centre in millihertz, negative for the lower sideband */
+void weaver_init(weaver_t *w, uint32_t sample_rate, int32_t centre_mhz, const int16_t *taps);
+void weaver_process(weaver_t *w, int16_t *iq, int16_t *audio, uint16_t n);
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""
+Generate src/band_plan.c, the flash-resident MS5351M register table used by
+Si5351_SetFrequency().
+
+Each band follows the Band class in src/Quadrature_Synthesis.ipynb: a fixed even
+output divider N (so CLK1_PHOFF = N gives quadrature), a fixed PLLA integer part
+a and denominator c chosen for the requested tuning step, leaving only b to be
+computed on the MCU.
+
+    python3 scripts/gen_band_plan.py > src/band_plan.c
+"""
+import math
+
+F_CLK = 25000000
+VCO_MIN = 600000000
+VCO_MAX = 900000000
+C_MAX = (1 << 20) - 1
+PHOFF_MAX = 127
+
+# name, f_low, f_high, delta_f (Hz)
+BANDS = [
+    ("160m",   1800000,   1950000, 10),
+    ("80m",    3500000,   3900000, 10),
+    ("40m",    7000000,   7300000, 10),
+    ("30m",   10100000,  10150000, 10),
+    ("20m",   14000000,  14350000, 10),
+    ("17m",   18068000,  18168000, 10),
+    ("15m",   21000000,  21450000, 10),
+    ("12m",   24890000,  24990000, 10),
+    ("10m",   28000000,  29700000, 10),
+    ("6m",    50000000,  51000000, 10),
+    ("2m",   144000000, 148000000, 10),
+]
+
+
+def ms_block(p1, p2, p3, r_div=0, divby4=0):
+    """Pack a PLL/Multisynth parameter set into its 8 register layout (AN619)."""
+    return [
+        (p3 >> 8) & 0xFF,
+        p3 & 0xFF,
+        ((r_div & 0x7) << 4) | ((divby4 & 0x3) << 2) | ((p1 >> 16) & 0x3),
+        (p1 >> 8) & 0xFF,
+        p1 & 0xFF,
+        ((p3 >> 12) & 0xF0) | ((p2 >> 16) & 0x0F),
+        (p2 >> 8) & 0xFF,
+        p2 & 0xFF,
+    ]
+
+
+def integer_ms_block(n):
+    if n == 4:
+        return ms_block(0, 0, 1, divby4=3)
+    return ms_block(128 * n - 512, 0, 1)
+
+
+class Band:
+    def __init__(self, name, f_low, f_high, delta_f):
+        self.name = name
+        self.f_low = f_low
+        self.f_high = f_high
+        self.N = 2 * math.ceil(VCO_MIN / (2 * f_low))
+        self.a = (self.N * f_low) // F_CLK
+        self.c = math.ceil(F_CLK / (self.N * delta_f))
+        self.b0 = ((self.N * f_low) % F_CLK) * self.c // F_CLK
+        self.c_per_hz_q32 = (self.c * (1 << 32) + F_CLK // 2) // F_CLK
+        self.phoff = self.N if self.N <= PHOFF_MAX else 0
+
+        assert self.c <= C_MAX, name
+        assert self.N * f_high <= VCO_MAX, name
+        assert (self.N * f_high - self.a * F_CLK) * self.c_per_hz_q32 < (1 << 64), name
+
+    def step(self):
+        return F_CLK / (self.N * self.c)
+
+
+def main():
+    print("/*")
+    print("\tMS5351M band plan register table.")
+    print("")
+    print("\tGenerated by scripts/gen_band_plan.py - do not edit by hand.")
+    print("*/")
+    print("")
+    print('#include "band_plan.h"')
+    print("")
+    print("const band_plan_t BAND_PLAN[] = {")
+    for b in BANDS:
+        band = Band(*b)
+        ms = ", ".join("0x%02X" % x for x in integer_ms_block(band.N))
+        print("\t/* %s: N=%d a=%d b0=%d c=%d step=%.6f Hz%s */" % (
+            band.name, band.N, band.a, band.b0, band.c, band.step(),
+            "" if band.phoff else ", no PHOFF quadrature"))
+        print("\t{ %9d, %9d, %3d, %3d, %2d, %6d, %8d, { %s } }," % (
+            band.f_low, band.f_high, band.N, band.phoff, band.a, band.c,
+            band.c_per_hz_q32, ms))
+    print("};")
+    print("")
+    print("const u8 BAND_PLAN_COUNT = sizeof(BAND_PLAN) / sizeof(BAND_PLAN[0]);")
+
+
+if __name__ == "__main__":
+    main()
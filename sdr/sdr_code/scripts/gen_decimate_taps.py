@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""
+Generate src/decimate_taps.c, the Q15 filter tables used by the decimation
+chain in src/decimate.c.
+
+The default chain takes the ADC from 768 kHz to 12 kHz:
+
+    CIC (order 4, /16) -> 48 kHz -> half-band /2 -> 24 kHz -> half-band /2 -> 12 kHz
+    -> compensating channel FIR
+
+Half-bands are Kaiser-windowed sincs; only the odd taps either side of the
+centre are stored since every other tap is zero and the centre is 1/2. The
+channel FIR is a windowed frequency-sampling design that flattens the CIC
+droop across the audio passband.
+
+    python3 scripts/gen_decimate_taps.py > src/decimate_taps.c
+"""
+import math
+
+ADC_RATE = 768000
+CIC_ORDER = 4
+CIC_RATE = 16
+OUT_RATE = ADC_RATE // CIC_RATE // 4
+
+HALFBAND_SHORT = 3      # non-zero taps per side: 11 tap filter
+HALFBAND_LONG = 6       # 23 tap filter for the last, sharpest stage
+HALFBAND_BETA = 6.0
+
+COMP_TAPS = 31
+COMP_PASS = 4000        # Hz, flattened to the CIC droop
+COMP_STOP = 5000        # Hz, rejected
+COMP_BETA = 5.0
+
+
+def bessel_i0(x):
+    s, t, k = 1.0, 1.0, 1
+    while t > 1e-12 * s:
+        t *= (x / (2 * k)) ** 2
+        s += t
+        k += 1
+    return s
+
+
+def kaiser(n, beta):
+    m = (n - 1) / 2
+    return [bessel_i0(beta * math.sqrt(1 - ((i - m) / m) ** 2)) / bessel_i0(beta) for i in range(n)]
+
+
+def quantise(h, total):
+    """Round to Q15 keeping the sum (DC gain) exact."""
+    q = [int(round(x * 32768)) for x in h]
+    q[len(q) // 2] += total - sum(q)
+    return q
+
+
+def halfband(per_side):
+    n = 4 * per_side - 1
+    w = kaiser(n, HALFBAND_BETA)
+    c = n // 2
+    odd = []
+    for j in range(per_side):
+        k = 2 * j + 1
+        odd.append(0.5 * math.sin(math.pi * k / 2) / (math.pi * k / 2) * w[c + k])
+    # The odd taps on both sides must sum to the other half of unity gain
+    scale = 0.25 / sum(odd)
+    q = [int(round(x * scale * 32768)) for x in odd]
+    q[0] += 8192 - sum(q)
+    return q
+
+
+def cic_droop(f):
+    x = math.pi * f / ADC_RATE
+    if x == 0:
+        return 1.0
+    return abs(math.sin(CIC_RATE * x) / (CIC_RATE * math.sin(x))) ** CIC_ORDER
+
+
+def compensator():
+    grid = 512
+    m = (COMP_TAPS - 1) / 2
+    desired = []
+    for k in range(grid + 1):
+        f = k * OUT_RATE / 2 / grid
+        if f <= COMP_PASS:
+            desired.append(1 / cic_droop(f))
+        elif f < COMP_STOP:
+            edge = 1 / cic_droop(COMP_PASS)
+            desired.append(edge * 0.5 * (1 + math.cos(math.pi * (f - COMP_PASS) / (COMP_STOP - COMP_PASS))))
+        else:
+            desired.append(0.0)
+    w = kaiser(COMP_TAPS, COMP_BETA)
+    h = []
+    for i in range(COMP_TAPS):
+        t = i - m
+        s = sum((1 if k in (0, grid) else 2) * d * math.cos(math.pi * k * t / grid)
+                for k, d in enumerate(desired))
+        h.append(s / (2 * grid) * w[i])
+    return quantise([x / sum(h) for x in h], 32768)
+
+
+def table(name, taps):
+    print("const int16_t %s[%d] = {" % (name, len(taps)))
+    for i in range(0, len(taps), 8):
+        print("\t" + " ".join("%6d," % t for t in taps[i:i + 8]))
+    print("};")
+    print("")
+
+
+def main():
+    print("/*")
+    print("\tQ15 tables for the decimation chain (%d Hz / %d / 4 = %d Hz)." % (ADC_RATE, CIC_RATE, OUT_RATE))
+    print("")
+    print("\tGenerated by scripts/gen_decimate_taps.py - do not edit by hand.")
+    print("*/")
+    print("")
+    print('#include "decimate.h"')
+    print("")
+    print("/* Odd taps h1, h3, ... of %d and %d tap half-bands; the centre tap is 16384 */" % (
+        4 * HALFBAND_SHORT - 1, 4 * HALFBAND_LONG - 1))
+    table("HALFBAND_SHORT", halfband(HALFBAND_SHORT))
+    table("HALFBAND_LONG", halfband(HALFBAND_LONG))
+    print("/* %d Hz channel filter, flat to %d Hz after CIC order %d / %d droop, stop from %d Hz */" % (
+        OUT_RATE, COMP_PASS, CIC_ORDER, CIC_RATE, COMP_STOP))
+    table("DECIMATE_COMP_TAPS", compensator())
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,238 @@
+#!/usr/bin/env python3
+"""
+Generate the golden vectors in test/golden for test/test_golden_vectors.
+
+The signals come from the models in model/SDR_reception.ipynb and
+model/Transmission.ipynb, re-run in plain Python at a scale the firmware can
+take:
+
+  fm_tone.gv   Reception notebook: an FM carrier (here a 500 Hz tone, 1 kHz
+               deviation, so it fits the 12 kHz channel) through the switching
+               mixer with a square-wave I/Q LO and the 3rd order 500 kHz
+               Butterworth low-pass. The carrier sits 1.1 kHz above the LO:
+               at 0 Hz its carrier would be taken out with the DC offset.
+  usb_tone.gv  Transmission notebook: quadrature up-conversion of a 1 kHz
+               tone by switching mixers (an upper sideband signal), received
+               by the same front end.
+
+The carrier is scaled from 50 MHz to 1.52 MHz and simulated at 32 x 768 kHz so
+the mixer model runs sample by sample in reasonable time; the switching mixer
+and LO do the same thing at any carrier. The ADC takes every 32nd sample of
+the low-pass output, 12 bit, packed as the DMA word (I in bits 11:0, Q in bits
+27:16). The notebook forms the baseband as i - jq; the words are packed so the
+firmware's I + jQ is that same signal.
+
+Before the ADC the Q channel gets a deliberate gain and phase error
+(Q' = IQ_GAIN (Q + IQ_SKEW I)) and both channels a DC offset, so the
+correction stage has something to correct: with iq_correct_process a no-op
+the image this leaves fails the "corrected" check.
+
+Each file holds the ADC input and the float reference at every stage the
+firmware implements, with the minimum SNR the runner must see there:
+
+  baseband   decimator output, 12 kHz I/Q (reference: the imbalanced baseband
+             through an ideal low-pass and /64)
+  corrected  iq_correct output (reference: the clean baseband the same way)
+  audio      demodulator output, 12 kHz (notebook discriminator and the
+             750 us de-emphasis for FM, the real part of the upper sideband
+             baseband for USB, both from the corrected reference)
+
+The analogue stages (RF, LO, mixer output) are not exported: no firmware block
+sees them.
+
+File layout, little-endian:
+    "GVEC", u32 version, u32 stages
+    per stage: char name[16], u32 type (0 packed ADC words, 1 complex float32,
+               2 float32), u32 rate, u32 count, float min_snr_db,
+               u32 settle (samples skipped before comparing), then the data
+
+    python3 scripts/gen_golden_vectors.py test/golden
+"""
+import math
+import os
+import struct
+import sys
+
+from gen_decimate_taps import ADC_RATE, OUT_RATE, kaiser
+
+OVERSAMPLE = 32
+FS = ADC_RATE * OVERSAMPLE          # model sample rate
+F_CARRIER = 1.52e6
+DURATION = 0.3                      # seconds
+F_CUTOFF = 500e3                    # analogue low-pass, as in the notebook
+
+F_VOICE = 1e3                       # USB tone
+FM_VOICE = 500
+FM_DELTA = 1e3                      # FM deviation
+FM_OFFSET = 1.1e3                   # FM carrier above the LO; 2x it is no multiple of FM_VOICE
+FM_DEEMPH = 750e-6                  # de-emphasis fm_demod applies in rx.c
+
+ADC_SCALE = 4000                    # counts per unit of mixer output
+ADC_DC = (40, -30)                  # I/Q offsets in counts for the DC blocker
+IQ_GAIN = 1.08                      # Q channel gain error
+IQ_SKEW = math.sin(math.radians(6)) # Q channel phase error, as the part of I leaking in
+
+REF_TAPS = 2047                     # reference decimation filter at ADC_RATE
+REF_CUTOFF = 4500
+REF_BETA = 8.0
+
+SETTLE = OUT_RATE // 10             # 100 ms of decimator, DC and imbalance settling
+
+TYPE_ADC, TYPE_COMPLEX, TYPE_REAL = 0, 1, 2
+
+
+def butter3(fc, fs):
+    """3rd order Butterworth low-pass by bilinear transform: a 1st and a 2nd order section."""
+    k = 1 / math.tan(math.pi * fc / fs)
+    # 1 / (s + 1)
+    a0 = k + 1
+    first = ((1 / a0, 1 / a0, 0), (1, (1 - k) / a0, 0))
+    # 1 / (s^2 + s + 1)
+    a0 = k * k + k + 1
+    second = ((1 / a0, 2 / a0, 1 / a0), (1, (2 - 2 * k * k) / a0, (k * k - k + 1) / a0))
+    return [first, second]
+
+
+def square(phase):
+    """scipy.signal.square with duty 0.5, shifted to 0/1 as the notebook's switches"""
+    return 1.0 if (phase / (2 * math.pi)) % 1.0 < 0.5 else 0.0
+
+
+def receive(rf):
+    """
+    Reception notebook front end: switch the RF with the I and Q LO squares (Q
+    lagging by 90 degrees), low-pass both, and sample every OVERSAMPLE-th value.
+    rf(n) gives the RF sample at n / FS. Returns the complex baseband i - jq.
+    """
+    sos = butter3(F_CUTOFF, FS)
+    state = [[0.0] * 4 for _ in range(2)]
+    out = []
+    w = 2 * math.pi * F_CARRIER / FS
+    for n in range(int(DURATION * FS)):
+        s = rf(n)
+        y = [s * square(w * n), s * square(w * n - math.pi / 2)]
+        for ch in range(2):
+            x = y[ch]
+            st = state[ch]
+            for j, (b, a) in enumerate(sos):
+                # transposed direct form II
+                v = b[0] * x + st[2 * j]
+                st[2 * j] = b[1] * x - a[1] * v + st[2 * j + 1]
+                st[2 * j + 1] = b[2] * x - a[2] * v
+                x = v
+            y[ch] = x
+        if n % OVERSAMPLE == 0:
+            out.append(complex(y[0], -y[1]))
+    return out
+
+
+def fm_rf(n):
+    """Reception notebook: FM carrier offset into 0..1 for the switches"""
+    t = n / FS
+    s = math.cos(2 * math.pi * (F_CARRIER + FM_OFFSET) * t + (FM_DELTA / FM_VOICE) * math.sin(2 * math.pi * FM_VOICE * t))
+    return (s + 1) / 2
+
+
+def usb_rf(n):
+    """
+    Transmission notebook: I_bb = cos(phi), Q_bb = -sin(phi) switched by the
+    I and Q LOs and summed, which leaves the upper sideband at the carrier. The
+    switches' DC term is dropped, as the transmit band-pass would: it leaks the
+    audio itself onto the RF, which the receiver's switches bring straight
+    back to baseband as a real (I = Q) tone.
+    """
+    t = n / FS
+    phi = 2 * math.pi * F_VOICE * t
+    w = 2 * math.pi * F_CARRIER * t
+    s = (square(w) - 0.5) * math.cos(phi) - (square(w - math.pi / 2) - 0.5) * math.sin(phi)
+    return (s / 2 + 1) / 2
+
+
+def adc_words(bb):
+    mean = sum(bb) / len(bb)
+    words = []
+    for z in bb:
+        i = int(round(2048 + ADC_DC[0] + ADC_SCALE * (z.real - mean.real)))
+        q = int(round(2048 + ADC_DC[1] + ADC_SCALE * (z.imag - mean.imag)))
+        words.append(max(0, min(4095, q)) << 16 | max(0, min(4095, i)))
+    return words
+
+
+def decimate_reference(bb):
+    """DC-free baseband through a long Kaiser low-pass, kept at OUT_RATE"""
+    mean = sum(bb) / len(bb)
+    w = kaiser(REF_TAPS, REF_BETA)
+    m = (REF_TAPS - 1) // 2
+    fc = REF_CUTOFF / ADC_RATE
+    h = [(2 * fc if t == 0 else math.sin(2 * math.pi * fc * t) / (math.pi * t)) * w[t + m]
+         for t in range(-m, m + 1)]
+    g = sum(h)
+    step = ADC_RATE // OUT_RATE
+    out = []
+    for c in range(0, len(bb), step):
+        acc = 0j
+        for k in range(max(0, c - m), min(len(bb), c + m + 1)):
+            acc += h[k - c + m] * (bb[k] - mean)
+        out.append(acc / g)
+    return out
+
+
+def imbalance(bb):
+    """Q channel gain and phase error of the analogue front end, the kind iq_correct undoes"""
+    return [complex(z.real, IQ_GAIN * (z.imag + IQ_SKEW * z.real)) for z in bb]
+
+
+def discriminator(bb):
+    """Reception notebook demodulator: unwrapped phase difference, then de-emphasis"""
+    alpha = 1 / (1 + OUT_RATE * FM_DEEMPH)
+    y = 0.0
+    out = [0.0]
+    for a, b in zip(bb, bb[1:]):
+        y += alpha * (math.atan2((b * a.conjugate()).imag, (b * a.conjugate()).real) - y)
+        out.append(y)
+    return out
+
+
+def stage(name, kind, rate, data, min_snr_db, settle):
+    head = struct.pack("<16sIIIfI", name.encode(), kind, rate, len(data), min_snr_db, settle)
+    if kind == TYPE_ADC:
+        body = struct.pack("<%dI" % len(data), *data)
+    elif kind == TYPE_COMPLEX:
+        body = struct.pack("<%df" % (2 * len(data)), *[v for z in data for v in (z.real, z.imag)])
+    else:
+        body = struct.pack("<%df" % len(data), *data)
+    return head + body
+
+
+def write(path, stages):
+    with open(path, "wb") as f:
+        f.write(b"GVEC" + struct.pack("<II", 1, len(stages)))
+        for s in stages:
+            f.write(s)
+    print("%s: %d stages" % (path, len(stages)), file=sys.stderr)
+
+
+def main():
+    out_dir = sys.argv[1] if len(sys.argv) > 1 else "test/golden"
+    os.makedirs(out_dir, exist_ok=True)
+
+    # Minimum SNRs sit about 6 dB under what the firmware measured when generated.
+    # With iq_correct_process a no-op "corrected" measured 23.5 (FM) and 23.7 (USB)
+    # dB; without its DC blocker FM "audio" measured 41 dB.
+    for name, rf, audio_of, snr in (
+            ("fm_tone", fm_rf, discriminator, (57, 33, 49)),
+            ("usb_tone", usb_rf, lambda bb: [z.real for z in bb], (53, 29, 47))):
+        bb = receive(rf)
+        skewed = imbalance(bb)
+        ref = decimate_reference(skewed)
+        corrected = decimate_reference(bb)
+        write(os.path.join(out_dir, name + ".gv"), [
+            stage("adc", TYPE_ADC, ADC_RATE, adc_words(skewed), 0, 0),
+            stage("baseband", TYPE_COMPLEX, OUT_RATE, ref, snr[0], SETTLE),
+            stage("corrected", TYPE_COMPLEX, OUT_RATE, corrected, snr[1], SETTLE),
+            stage("audio", TYPE_REAL, OUT_RATE, audio_of(corrected), snr[2], SETTLE),
+        ])
+
+
+if __name__ == "__main__":
+    main()
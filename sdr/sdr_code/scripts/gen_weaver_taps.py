@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+"""
+Generate src/weaver_taps.c, the Q15 low-pass filters of the Weaver SSB/CW
+demodulator in src/weaver.c.
+
+The Weaver path shifts the wanted sideband so its centre sits at 0 Hz, low-pass
+filters I and Q with the same real filter, and shifts back: the low-pass cutoff
+is half the audio bandwidth.
+
+    python3 scripts/gen_weaver_taps.py > src/weaver_taps.c
+"""
+import math
+
+from gen_decimate_taps import OUT_RATE, kaiser, quantise, table
+
+TAPS = 63
+BETA = 5.5
+
+# name, cutoff (Hz): SSB 300-2700 Hz around a 1500 Hz centre, CW 500 Hz wide
+FILTERS = [
+    ("WEAVER_SSB_TAPS", 1200),
+    ("WEAVER_CW_TAPS", 250),
+]
+
+
+def lowpass(cutoff):
+    m = (TAPS - 1) / 2
+    w = kaiser(TAPS, BETA)
+    fc = cutoff / OUT_RATE
+    h = []
+    for i in range(TAPS):
+        t = i - m
+        h.append((2 * fc if t == 0 else math.sin(2 * math.pi * fc * t) / (math.pi * t)) * w[i])
+    return quantise([x / sum(h) for x in h], 32768)
+
+
+def main():
+    print("/*")
+    print("\tQ15 Weaver low-pass filters, %d taps at %d Hz." % (TAPS, OUT_RATE))
+    print("")
+    print("\tGenerated by scripts/gen_weaver_taps.py - do not edit by hand.")
+    print("*/")
+    print("")
+    print('#include "weaver.h"')
+    print("")
+    for name, cutoff in FILTERS:
+        print("/* Cutoff %d Hz */" % cutoff)
+        table(name, lowpass(cutoff))
+
+
+if __name__ == "__main__":
+    main()
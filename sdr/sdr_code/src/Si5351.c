@@ -1,72 +1,182 @@
 #include <ch32v30x.h>
+#include "Si5351.h"
+#include "band_plan.h"
+#include "Si5351_Solver.h"
+#include "i2c1_queue.h"
+#include "prof.h"
 
-void I2C_StartTx(u8 slave_address) {
-	while( I2C_GetFlagStatus( I2C1, I2C_FLAG_BUSY ) != RESET );
-	I2C_GenerateSTART(I2C1, ENABLE);
-	while(!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_MODE_SELECT));
+const u8 SI5351_ADDRESS = 0b1100000;
+
+u8 Si5351_ReadRegister(u8 reg) {
+	/* 
+		A read operation is performed in two stages. A data write is used to set the register address, then a data read is
+		performed to retrieve the data from the set address. A read burst operation is also supported.
+
+		Reads are rare (status polling), so this one waits for the queue to drain.
+	*/
+    u8 ret = 0;
+
+	I2C1_Queue_Read(SI5351_ADDRESS, reg, &ret, 1, 0, 0);
+	I2C1_Queue_Flush();
 
-	I2C_Send7bitAddress( I2C1, slave_address << 1, I2C_Direction_Transmitter );
+	return ret;
+}
 
-    while( !I2C_CheckEvent( I2C1, I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED ) );
+/* True while queued register writes are still going out on I2C1 */
+int Si5351_Busy(void) {
+	return !I2C1_Queue_Idle();
 }
 
-void I2C_StartRx(u8 slave_address) {
-	while( I2C_GetFlagStatus( I2C1, I2C_FLAG_BUSY ) != RESET );
-	I2C_GenerateSTART(I2C1, ENABLE);
-	while(!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_MODE_SELECT));
+/*
+	RAM mirror of every register the firmware has written, so that retuning only
+	has to transmit the bytes that actually change.
+*/
+#define SI5351_REG_COUNT 188
+#define SI5351_MERGE_GAP 3  // re-addressing costs START, address and register bytes
 
-	I2C_Send7bitAddress( I2C1, slave_address << 1, I2C_Direction_Receiver );
+static u8 shadow[SI5351_REG_COUNT];
+static u8 shadow_valid[(SI5351_REG_COUNT + 7) / 8];
 
-	while( !I2C_CheckEvent( I2C1, I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED ) );
+static void Si5351_Remember(u8 reg, const u8 *buf, u8 len) {
+	for (u8 i=0; i<len; i++, reg++) {
+		shadow[reg] = buf[i];
+		shadow_valid[reg >> 3] |= 1 << (reg & 7);
+	}
 }
 
-void I2C_TxByte(u8 data) {
-    while (I2C_GetFlagStatus(I2C1, I2C_FLAG_TXE) == RESET) ;
-    I2C_SendData( I2C1, data );
-    while( !I2C_CheckEvent( I2C1, I2C_EVENT_MASTER_BYTE_TRANSMITTED ) );
+static int Si5351_Cached(u8 reg, u8 data) {
+	return (shadow_valid[reg >> 3] & (1 << (reg & 7))) && shadow[reg] == data;
 }
 
-u8 I2C_RxByte(void) {
-	while( I2C_GetFlagStatus(I2C1, I2C_FLAG_RXNE) == RESET );
-    u8 ret = I2C_ReceiveData( I2C1 );
-	while( !I2C_CheckEvent( I2C1, I2C_EVENT_MASTER_BYTE_RECEIVED ) );
-	return ret;
+void Si5351_InvalidateCache(void) {
+	for (u8 i=0; i<sizeof(shadow_valid); i++) {
+		shadow_valid[i] = 0;
+	}
 }
 
-const u8 SI5351_ADDRESS = 0b1100000;
+int Si5351_BlockCached(u8 reg, const u8 *buf, u8 len) {
+	for (u8 i=0; i<len; i++) {
+		if (!Si5351_Cached(reg + i, buf[i]))
+			return 0;
+	}
+	return 1;
+}
 
-u8 Si5351_ReadRegister(u8 reg) {
+int Si5351_WriteRegister(u8 reg, u8 data) {
 	/* 
-		A read operation is performed in two stages. A data write is used to set the register address, then a data read is
-		performed to retrieve the data from the set address. A read burst operation is also supported.
+		Data is transferred MSB first in 8-bit words as specified by the I 2C specification. A write command consists of a 7-
+		bit device (slave) address + a write bit, an 8-bit register address, and 8 bits of data
 	*/
-    u8 ret = 0;
-	
-	I2C_StartTx(SI5351_ADDRESS);
-	I2C_TxByte(reg);
-    I2C_GenerateSTOP( I2C1, ENABLE );
+	if (I2C1_Queue_Write(SI5351_ADDRESS, reg, &data, 1, 0, 0) != 0)
+		return -1;
 
-	/* Step 2. Perform a read, to retrieve the data */
+	Si5351_Remember(reg, &data, 1);
+	return 0;
+}
 
-	I2C_StartRx(SI5351_ADDRESS);
-    ret = I2C_RxByte();
-    I2C_GenerateSTOP( I2C1, ENABLE );
+int Si5351_WriteBlock(u8 reg, const u8 *buf, u8 len) {
+	/*
+		Burst write: the register address auto-increments after every data byte, so a
+		whole PLL or Multisynth parameter block goes out in a single transaction.
+		The block is copied into the I2C1 queue, so this returns before it is sent.
+		Blocks longer than one queue entry go out as several bursts. Only bytes the
+		queue accepted reach the cache; returns -1 if it refused any.
+	*/
+	while (len) {
+		u8 n = len > I2C1_QUEUE_DATA_MAX ? I2C1_QUEUE_DATA_MAX : len;
 
-	return ret;
+		if (I2C1_Queue_Write(SI5351_ADDRESS, reg, buf, n, 0, 0) != 0)
+			return -1;
+		Si5351_Remember(reg, buf, n);
+		reg += n;
+		buf += n;
+		len -= n;
+	}
+	return 0;
 }
 
-void Si5351_WriteRegister(u8 reg, u8 data) {
-	/* 
-		Data is transferred MSB first in 8-bit words as specified by the I 2C specification. A write command consists of a 7-
-		bit device (slave) address + a write bit, an 8-bit register address, and 8 bits of data
-	*/
-    I2C_StartTx(SI5351_ADDRESS);
-	I2C_TxByte(reg);
-	I2C_TxByte(data);
-    I2C_GenerateSTOP( I2C1, ENABLE );
+/*
+	Differential burst write: only registers whose cached value differs are sent.
+	Changed runs separated by up to SI5351_MERGE_GAP unchanged registers share one
+	transaction. Returns the number of data bytes transmitted; stops early if the
+	queue refuses a run, whose registers then stay uncached and are sent next time.
+*/
+u8 Si5351_UpdateBlock(u8 reg, const u8 *buf, u8 len) {
+	u8 sent = 0;
+	u8 i = 0;
+
+	while (i < len) {
+		if (Si5351_Cached(reg + i, buf[i])) {
+			i++;
+			continue;
+		}
+
+		u8 first = i;
+		u8 last = i;
+		for (i++; i < len && i - last <= SI5351_MERGE_GAP; i++) {
+			if (!Si5351_Cached(reg + i, buf[i]))
+				last = i;
+		}
+
+		if (Si5351_WriteBlock(reg + first, &buf[first], last - first + 1) != 0)
+			break;
+		sent += last - first + 1;
+		i = last + 1;
+	}
+	return sent;
+}
+
+/*
+	Pack a feedback or output divider a + b/c into the 8 register layout shared by
+	the PLL (26-33, 34-41) and Multisynth (42-49, ...) parameter blocks (AN619 3.2).
+*/
+static void Si5351_PackParameters(u8 *block, u32 a, u32 b, u32 c) {
+	u32 f = (128 * b) / c;
+	u32 p1 = 128 * a + f - 512;
+	u32 p2 = 128 * b - c * f;
+	u32 p3 = c;
+
+	block[0] = (p3 >> 8) & 0xFF;
+	block[1] = p3 & 0xFF;
+	block[2] = (p1 >> 16) & 0x03;
+	block[3] = (p1 >> 8) & 0xFF;
+	block[4] = p1 & 0xFF;
+	block[5] = ((p3 >> 12) & 0xF0) | ((p2 >> 16) & 0x0F);
+	block[6] = (p2 >> 8) & 0xFF;
+	block[7] = p2 & 0xFF;
+}
+
+static const band_plan_t *Si5351_FindBand(u32 frequency) {
+	for (u8 i = 0; i < BAND_PLAN_COUNT; i++) {
+		if (frequency >= BAND_PLAN[i].f_low && frequency <= BAND_PLAN[i].f_high)
+			return &BAND_PLAN[i];
+	}
+	return 0;
+}
+
+/* CLK0-7 control registers (16-23) */
+static const u8 CLK_POWERDOWN[8] = { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 };
+static const u8 CLK_QUADRATURE[2] = { 0x4F, 0x4F };
+static const u8 CLK_SOURCE_XTAL[1] = { 0x00 };
+static const u8 XTAL_LOAD_10PF[1] = { 0xC0 };
+
+/*
+	Integer Multisynth divider N with output divider R = 2^r_div. N = 4 uses the
+	MSx_DIVBY4 mode, which requires P1 = P2 = 0 (as packed for a = 4).
+*/
+static void Si5351_PackMultisynth(u8 *block, u32 N, u8 r_div) {
+	Si5351_PackParameters(block, N, 0, 1);
+	if (N == 4)
+		block[2] |= 0x0C;
+	block[2] |= (r_div & 0x07) << 4;
 }
 
-void Si5351_SetFrequency(float frequency) {
+/*
+	Returns 0 on success, -1 if the frequency is outside the 2.5 kHz - 200 MHz range.
+	Frequencies inside the band plan use the precomputed table, anything else goes
+	through the rational solver.
+*/
+static int Si5351_Program(u32 frequency) {
 	/* 
 		Step 1: Disable Outputs
 		Step 2: Set PLLA to desired frequency
@@ -77,27 +187,76 @@ void Si5351_SetFrequency(float frequency) {
 		https://www.skyworksinc.com/-/media/Skyworks/SL/documents/public/application-notes/AN619.pdf
 		https://github.com/MR-DOS/Si5351-lib/blob/master/src/si5351.c
 	*/
+	u8 pll[8];
+	u8 ms[16];  // MS0 (42-49) and MS1 (50-57) back to back
+	u8 phoff[2];
+
+	const band_plan_t *band = Si5351_FindBand(frequency);
+	if (band != 0) {
+		/*
+			f_vco = f_clk * (a + b/c) = N * f, so b = (N * f - a * f_clk) * c / f_clk.
+			Carry into a when the band runs past the top of its starting VCO slot.
+		*/
+		u32 vco_offset = frequency * band->N - (u32)band->a * SI5351_XTAL_FREQ;
+		u32 b = (u32)(((uint64_t)vco_offset * band->c_per_hz_q32 + 0x80000000u) >> 32);
+		u32 a = band->a + b / band->c;
+		b = b % band->c;
+
+		Si5351_PackParameters(pll, a, b, band->c);
+		for (int i=0; i<8; i++) {
+			ms[i] = band->ms[i];
+		}
+		phoff[1] = band->phoff;
+	} else {
+		si5351_params_t params;
+		if (Si5351_Solve(SI5351_XTAL_FREQ, frequency, &params) != 0)
+			return -1;
+
+		Si5351_PackParameters(pll, params.a, params.b, params.c);
+		Si5351_PackMultisynth(ms, params.N, params.r_div);
+		phoff[1] = params.phoff;
+	}
+
+	/* CLK1 is an identical copy of CLK0, lagging it by N quarter VCO periods (90 degrees) */
+	for (int i=0; i<8; i++) {
+		ms[8 + i] = ms[i];
+	}
+	phoff[0] = 0;
+
+	/*
+		Same output dividers and phase offset: MS0 and MS1 keep their phase relation
+		and only PLLA moves, which it does without a glitch. Skip the output disable
+		and PLL reset and send just the changed feedback bytes (usually P1/P2 of b).
+	*/
+	if (Si5351_BlockCached(42, ms, sizeof(ms)) &&
+		Si5351_BlockCached(165, phoff, sizeof(phoff)) &&
+		Si5351_BlockCached(16, CLK_QUADRATURE, sizeof(CLK_QUADRATURE))) {
+		Si5351_UpdateBlock(26, pll, sizeof(pll));
+		return 0;
+	}
 
 	/* Step 1: Disable Outputs */
 	Si5351_WriteRegister(3, 0xFF);
 	Si5351_WriteRegister(9, 0xFF);
 
 	/* Powerdown all output drivers: Reg. 16, 17, 18, 19, 20, 21, 22, 23 = 0x80 */
-	for (int clk=0; clk<=7; clk++) {
-		Si5351_WriteRegister(16 + clk, 0x80);
-	}
+	Si5351_WriteBlock(16, CLK_POWERDOWN, sizeof(CLK_POWERDOWN));
+
 	/* Set Interrupt Masks Reg 2:  Unused on The Si5351A */
 
 	/* Set CLK0 to use PLLA */
-	Si5351_WriteRegister(15, 0x00); // Use XTAL as PLL clock source
-
-	/* Write configuration map of all registers */
-
+	Si5351_UpdateBlock(15, CLK_SOURCE_XTAL, sizeof(CLK_SOURCE_XTAL)); // Use XTAL as PLL clock source
 
+	/* PLLA feedback divider, then MS0 and MS1 output dividers, one burst each */
+	Si5351_UpdateBlock(26, pll, sizeof(pll));
+	Si5351_UpdateBlock(42, ms, sizeof(ms));
+	Si5351_UpdateBlock(165, phoff, sizeof(phoff));
 
+	/* CLK0/CLK1 powered up, integer mode, PLLA, Multisynth source, 8 mA */
+	Si5351_WriteBlock(16, CLK_QUADRATURE, sizeof(CLK_QUADRATURE));
 
     /* Set Crystal Load Capacitance */
-	Si5351_WriteRegister(183, 0xC0); // 10pF
+	Si5351_UpdateBlock(183, XTAL_LOAD_10PF, sizeof(XTAL_LOAD_10PF)); // 10pF
 
 	/* Soft Reset PLLA and PLLB */
 	
@@ -106,5 +265,14 @@ void Si5351_SetFrequency(float frequency) {
 	/* Enable CLK0 and CLK1 */
 	Si5351_WriteRegister(3, 0b11111100);
 
+	return 0;
 }
 
+int Si5351_SetFrequency(u32 frequency) {
+	int result;
+	PROF_BEGIN(PROF_SI5351_SET_FREQUENCY);
+
+	result = Si5351_Program(frequency);
+	PROF_END(PROF_SI5351_SET_FREQUENCY);
+	return result;
+}
@@ -0,0 +1,104 @@
+/*
+	MS5351M PLL / Multisynth solver.
+
+	Replaces the brute force get_closest_vco() search in Quadrature_Synthesis.ipynb.
+	The output divider is fixed by the VCO limits, which makes the required feedback
+	ratio an exact fraction f_vco / f_clk. When its reduced denominator does not fit
+	in 20 bits it is replaced by the best rational approximation, found from the
+	continued fraction expansion (at most ~45 terms for 32 bit operands), so the
+	solver runs in bounded time on the CH32V305 as well as on the host.
+*/
+#include "Si5351_Solver.h"
+
+/*
+	Best approximation p/q of num/den (num < den) with q <= max_den.
+
+	Walks the convergents and finishes with the largest admissible semiconvergent.
+	A semiconvergent with t > a_i/2 is closer than the previous convergent; the
+	exact tie t == a_i/2 goes to the convergent.
+*/
+static void best_rational(uint32_t num, uint32_t den, uint32_t max_den, uint32_t *p, uint32_t *q) {
+	uint32_t h0 = 0, h1 = 1;    // numerators of convergents i-2, i-1
+	uint32_t k0 = 1, k1 = 0;    // denominators of convergents i-2, i-1
+
+	while (den != 0) {
+		uint32_t ai = num / den;
+		uint32_t rem = num % den;
+
+		if (ai != 0 && k1 != 0 && (max_den - k0) / k1 < ai) {
+			uint32_t t = (max_den - k0) / k1;
+			if (2 * t > ai) {
+				h1 = h0 + t * h1;
+				k1 = k0 + t * k1;
+			}
+			break;
+		}
+
+		uint32_t h = ai * h1 + h0;
+		uint32_t k = ai * k1 + k0;
+		h0 = h1; h1 = h;
+		k0 = k1; k1 = k;
+
+		num = den;
+		den = rem;
+	}
+
+	*p = h1;
+	*q = k1;
+}
+
+/*
+	Find PLLA and Multisynth settings for frequency (Hz) from a crystal f_clk.
+
+	Returns 0 on success, -1 when the frequency is outside 2.5 kHz - 200 MHz.
+	Quadrature (phoff != 0) is available from f_vco_min / 126 up to 200 MHz;
+	below that the 7 bit phase offset register cannot reach N.
+*/
+int Si5351_Solve(uint32_t f_clk, uint32_t frequency, si5351_params_t *params) {
+	uint32_t N;
+	uint8_t r_div = 0;
+
+	if (frequency < SI5351_FREQ_MIN || frequency > SI5351_FREQ_MAX)
+		return -1;
+
+	if (frequency > SI5351_VCO_MAX / 6) {
+		N = 4;  // above 150 MHz the Multisynth must divide by exactly 4
+	} else {
+		/* Slow outputs need the R divider to bring N back under 2048 */
+		while ((uint32_t)(SI5351_VCO_MIN >> r_div) / SI5351_N_MAX >= frequency)
+			r_div++;
+
+		/* Smallest even N that puts the VCO at or above 600 MHz, as in the band plan */
+		uint32_t f_r = frequency << r_div;
+		N = (SI5351_VCO_MIN + 2 * f_r - 1) / (2 * f_r) * 2;
+		if (N < 6)
+			N = 6;
+	}
+
+	uint32_t f_vco = (frequency << r_div) * N;
+	uint32_t a = f_vco / f_clk;
+	uint32_t b = f_vco % f_clk;
+	uint32_t c = f_clk;
+
+	if (c > SI5351_C_MAX)
+		best_rational(b, c, SI5351_C_MAX, &b, &c);
+	if (b == c) {
+		a += 1;
+		b = 0;
+		c = 1;
+	}
+
+	params->a = a;
+	params->b = b;
+	params->c = c;
+	params->N = N;
+	params->r_div = r_div;
+	params->phoff = (r_div == 0 && N <= SI5351_PHOFF_MAX) ? N : 0;
+
+	/* error = f_clk * (a*c + b) / (c * N * R) - frequency */
+	int64_t num = (int64_t)f_clk * ((int64_t)a * c + b) - (int64_t)f_vco * c;
+	int64_t den = (int64_t)c * N << r_div;
+	params->error_mhz = (int32_t)(num * 1000 / den);
+
+	return 0;
+}
@@ -0,0 +1,155 @@
+#include <ch32v30x.h>
+#include "adc_iq.h"
+#include "hardware.h"
+
+void DMA1_Channel1_IRQHandler(void) __attribute__((interrupt()));
+
+static u32 *capture_buffer;
+static u16 half_length;
+static adc_iq_callback_t capture_callback;
+static void *capture_context;
+static volatile u32 blocks;
+
+static void ADC_IQ_Channel_Init(ADC_TypeDef *adc, u8 channel, u32 trigger, u8 sample_time) {
+    ADC_InitTypeDef ADC_InitStructure = {0};
+
+    ADC_DeInit(adc);
+    ADC_InitStructure.ADC_Mode = ADC_Mode_RegSimult;
+    ADC_InitStructure.ADC_ScanConvMode = DISABLE;
+    ADC_InitStructure.ADC_ContinuousConvMode = DISABLE;
+    ADC_InitStructure.ADC_ExternalTrigConv = trigger;
+    ADC_InitStructure.ADC_DataAlign = ADC_DataAlign_Right;
+    ADC_InitStructure.ADC_NbrOfChannel = 1;
+    ADC_InitStructure.ADC_OutputBuffer = ADC_OutputBuffer_Disable;
+    ADC_InitStructure.ADC_Pga = ADC_Pga_1;
+    ADC_Init(adc, &ADC_InitStructure);
+
+    ADC_RegularChannelConfig(adc, channel, 1, sample_time);
+    ADC_ExternalTrigConvCmd(adc, ENABLE);
+    ADC_Cmd(adc, ENABLE);
+
+    ADC_ResetCalibration(adc);
+    while (ADC_GetResetCalibrationStatus(adc));
+    ADC_StartCalibration(adc);
+    while (ADC_GetCalibrationStatus(adc));
+}
+
+/*********************************************************************
+ * @fn      ADC_IQ_Start
+ *
+ * @brief   Starts simultaneous I/Q capture.
+ *
+ * @param   sample_rate - pairs per second, clamped to ADC_IQ_MAX_RATE and to
+ *                        the lowest rate TIM3's 16 bit period reaches (~2.2 kHz)
+ *          buffer - length words, each half is passed to callback in turn
+ *          length - total pairs, even
+ *          callback - runs in the DMA interrupt with the half just filled,
+ *                     which it may overwrite while DMA fills the other
+ *          context - passed to callback
+ *
+ * @return  the rate actually set, SystemCoreClock / timer period
+ */
+u32 ADC_IQ_Start(u32 sample_rate, u32 *buffer, u16 length, adc_iq_callback_t callback, void *context) {
+    GPIO_InitTypeDef GPIO_InitStructure = {0};
+    DMA_InitTypeDef DMA_InitStructure = {0};
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseInitStructure = {0};
+    NVIC_InitTypeDef NVIC_InitStructure = {0};
+
+    ADC_IQ_Stop();
+
+    capture_buffer = buffer;
+    half_length = length / 2;
+    capture_callback = callback;
+    capture_context = context;
+    blocks = 0;
+
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA | RCC_APB2Periph_ADC1 | RCC_APB2Periph_ADC2, ENABLE);
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM3, ENABLE);
+    RCC_ADCCLKConfig(RCC_PCLK2_Div12);
+
+    GPIO_InitStructure.GPIO_Pin = ADC_I_PIN;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AIN;
+    GPIO_Init(ADC_I_PORT, &GPIO_InitStructure);
+    GPIO_InitStructure.GPIO_Pin = ADC_Q_PIN;
+    GPIO_Init(ADC_Q_PORT, &GPIO_InitStructure);
+
+    /* TIM3 counts at HCLK into a 16 bit period, which sets the lowest rate */
+    if (sample_rate > ADC_IQ_MAX_RATE)
+        sample_rate = ADC_IQ_MAX_RATE;
+    if (sample_rate < SystemCoreClock / 65536 + 1)
+        sample_rate = SystemCoreClock / 65536 + 1;
+
+    /* Longest sample time whose conversion (sample time + 12.5 ADC clocks) fits the period */
+    u32 cycles = ADC_IQ_CLOCK / sample_rate;
+    u8 sample_time = cycles >= 26 ? ADC_SampleTime_13Cycles5 :
+                     cycles >= 20 ? ADC_SampleTime_7Cycles5 : ADC_SampleTime_1Cycles5;
+
+    /* ADC2 is the slave: it converts whenever ADC1 is triggered */
+    ADC_IQ_Channel_Init(ADC2, ADC_Channel_2, ADC_ExternalTrigConv_None, sample_time);
+    ADC_IQ_Channel_Init(ADC1, ADC_Channel_1, ADC_ExternalTrigConv_T3_TRGO, sample_time);
+
+    /* In dual mode ADC1's data register carries ADC2's result in the upper half */
+    DMA_DeInit(DMA1_Channel1);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (u32)&ADC1->RDATAR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (u32)buffer;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_BufferSize = length;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Word;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_VeryHigh;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(DMA1_Channel1, &DMA_InitStructure);
+    DMA_ITConfig(DMA1_Channel1, DMA_IT_HT | DMA_IT_TC, ENABLE);
+    DMA_Cmd(DMA1_Channel1, ENABLE);
+    ADC_DMACmd(ADC1, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel1_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    /* TIM3 update -> TRGO starts each conversion pair; APB1 runs at HCLK/2 so TIM3 counts at HCLK */
+    TIM_TimeBaseInitStructure.TIM_Period = SystemCoreClock / sample_rate - 1;
+    TIM_TimeBaseInitStructure.TIM_Prescaler = 0;
+    TIM_TimeBaseInitStructure.TIM_ClockDivision = TIM_CKD_DIV1;
+    TIM_TimeBaseInitStructure.TIM_CounterMode = TIM_CounterMode_Up;
+    TIM_TimeBaseInit(TIM3, &TIM_TimeBaseInitStructure);
+    TIM_SelectOutputTrigger(TIM3, TIM_TRGOSource_Update);
+    TIM_Cmd(TIM3, ENABLE);
+
+    return SystemCoreClock / (TIM_TimeBaseInitStructure.TIM_Period + 1);
+}
+
+void ADC_IQ_Stop(void) {
+    TIM_Cmd(TIM3, DISABLE);
+    DMA_ITConfig(DMA1_Channel1, DMA_IT_HT | DMA_IT_TC, DISABLE);
+    DMA_Cmd(DMA1_Channel1, DISABLE);
+}
+
+u32 ADC_IQ_Blocks(void) {
+    return blocks;
+}
+
+void DMA1_Channel1_IRQHandler(void) {
+    u32 *half;
+
+    if (DMA_GetITStatus(DMA1_IT_HT1) != RESET) {
+        DMA_ClearITPendingBit(DMA1_IT_HT1);
+        half = capture_buffer;
+    } else if (DMA_GetITStatus(DMA1_IT_TC1) != RESET) {
+        DMA_ClearITPendingBit(DMA1_IT_TC1);
+        half = capture_buffer + half_length;
+    } else {
+        DMA_ClearITPendingBit(DMA1_IT_GL1);
+        return;
+    }
+
+    blocks++;
+    if (capture_callback)
+        capture_callback(half, half_length, capture_context);
+}
@@ -0,0 +1,155 @@
+/*
+	Block AGC: peak envelope, log-domain gain law, ramped linear gain.
+*/
+#include "agc.h"
+
+/* 256 * log2(1 + i/32) */
+static const uint16_t LOG2_FRAC[33] = {
+	  0,  11,  22,  33,  44,  54,  63,  73,  82,  92, 100, 109, 118, 126, 134, 142,
+	150, 157, 165, 172, 179, 186, 193, 200, 207, 213, 220, 226, 232, 238, 244, 250,
+	256,
+};
+
+/* 65536 * 2^(i/32) */
+static const uint32_t EXP2_FRAC[33] = {
+	 65536,  66971,  68438,  69936,  71468,  73032,  74632,  76266,
+	 77936,  79642,  81386,  83169,  84990,  86851,  88752,  90696,
+	 92682,  94711,  96785,  98905, 101070, 103283, 105545, 107856,
+	110218, 112631, 115098, 117618, 120194, 122825, 125515, 128263,
+	131072,
+};
+
+#define AGC_MAX_GAIN_LOG (14 * 256)     // keeps the Q16 linear gain below 2^31
+
+/* log2(x) in Q8, 0 for x <= 1 */
+int32_t agc_log2_q8(uint32_t x) {
+	if (x <= 1)
+		return 0;
+
+	int msb = 31 - __builtin_clz(x);
+	uint32_t m = x << (31 - msb);
+	uint32_t idx = (m >> 26) & 31;
+	uint32_t frac = (m >> 18) & 0xFF;
+
+	return msb * 256 + LOG2_FRAC[idx] + (((LOG2_FRAC[idx + 1] - LOG2_FRAC[idx]) * frac) >> 8);
+}
+
+/* 2^(x / 256) in Q16 */
+uint32_t agc_exp2_q16(int32_t x) {
+	int32_t whole = x >> 8;
+	uint32_t f = x & 0xFF;
+	uint32_t idx = f >> 3;
+	uint32_t m = EXP2_FRAC[idx] + (((EXP2_FRAC[idx + 1] - EXP2_FRAC[idx]) * (f & 7)) >> 3);
+
+	if (whole >= 0)
+		return m << whole;
+	if (whole < -31)
+		return 0;
+	return m >> -whole;
+}
+
+/*
+	target is the wanted peak output (Q15), max_gain_db caps the gain on noise,
+	attack_ms is the time constant for gain reduction, hang_ms how long gain is
+	held after a peak and decay_db_per_s how fast it then recovers.
+*/
+void agc_init(agc_t *agc, uint32_t sample_rate, uint16_t block_len, int16_t target,
+              uint8_t max_gain_db, uint16_t attack_ms, uint16_t decay_db_per_s, uint16_t hang_ms) {
+	uint32_t block_us = (uint32_t)((uint64_t)block_len * 1000000 / sample_rate);
+
+	agc->target_log = agc_log2_q8(target > 0 ? target : 1);
+	agc->max_gain_log = (int32_t)max_gain_db * 25600 / 602;
+	if (agc->max_gain_log > AGC_MAX_GAIN_LOG)
+		agc->max_gain_log = AGC_MAX_GAIN_LOG;
+	agc->attack = (int32_t)(32768ull * block_us / ((uint64_t)attack_ms * 1000 + block_us));
+	agc->decay_step = (int32_t)((uint64_t)decay_db_per_s * 25600 * block_us / (602 * 1000000ull));
+	if (agc->decay_step < 1)
+		agc->decay_step = 1;
+	agc->hang_blocks = (uint16_t)((uint32_t)hang_ms * 1000 / (block_us ? block_us : 1));
+	agc->hang = 0;
+	agc->gain_log = 0;
+	agc->gain_lin = 1 << 16;
+}
+
+/* Move the log gain for a block whose peak magnitude is peak; returns the new Q16 gain */
+static uint32_t agc_update(agc_t *agc, uint32_t peak) {
+	int32_t want = agc->target_log - agc_log2_q8(peak);
+
+	if (want > agc->max_gain_log)
+		want = agc->max_gain_log;
+
+	if (want < agc->gain_log) {
+		int32_t drop = ((agc->gain_log - want) * agc->attack) >> 15;
+		agc->gain_log -= drop ? drop : 1;
+		agc->hang = agc->hang_blocks;
+	} else if (agc->hang) {
+		agc->hang--;
+	} else {
+		agc->gain_log += agc->decay_step;
+		if (agc->gain_log > want)
+			agc->gain_log = want;
+	}
+	return agc_exp2_q16(agc->gain_log);
+}
+
+static inline int16_t agc_apply(int16_t x, uint32_t gain) {
+	int32_t y = (int32_t)(((int64_t)x * gain) >> 16);
+
+	if (y > 32767)
+		return 32767;
+	if (y < -32768)
+		return -32768;
+	return (int16_t)y;
+}
+
+void agc_process(agc_t *agc, int16_t *x, uint16_t n) {
+	uint32_t peak = 0;
+
+	if (!n)
+		return;
+	for (uint16_t k = 0; k < n; k++) {
+		uint32_t a = x[k] < 0 ? -(int32_t)x[k] : x[k];
+		if (a > peak)
+			peak = a;
+	}
+
+	uint32_t from = agc->gain_lin, to = agc_update(agc, peak);
+	int32_t step = ((int32_t)to - (int32_t)from) / n;
+
+	for (uint16_t k = 0; k < n; k++) {
+		from += step;
+		x[k] = agc_apply(x[k], from);
+	}
+	agc->gain_lin = to;
+}
+
+/* Peak |I + jQ| by alpha max plus beta min (15/16, 15/32): within 6.2% */
+void agc_process_iq(agc_t *agc, int16_t *iq, uint16_t n) {
+	uint32_t peak = 0;
+
+	if (!n)
+		return;
+	for (uint16_t k = 0; k < n; k++) {
+		uint32_t a = iq[2 * k] < 0 ? -(int32_t)iq[2 * k] : iq[2 * k];
+		uint32_t b = iq[2 * k + 1] < 0 ? -(int32_t)iq[2 * k + 1] : iq[2 * k + 1];
+		uint32_t hi = a > b ? a : b, lo = a > b ? b : a;
+		uint32_t m = (hi * 15 >> 4) + (lo * 15 >> 5);
+
+		if (m > peak)
+			peak = m;
+	}
+
+	uint32_t from = agc->gain_lin, to = agc_update(agc, peak);
+	int32_t step = ((int32_t)to - (int32_t)from) / n;
+
+	for (uint16_t k = 0; k < n; k++) {
+		from += step;
+		iq[2 * k] = agc_apply(iq[2 * k], from);
+		iq[2 * k + 1] = agc_apply(iq[2 * k + 1], from);
+	}
+	agc->gain_lin = to;
+}
+
+int16_t agc_gain_db10(const agc_t *agc) {
+	return (int16_t)(agc->gain_log * 602 / 2560);
+}
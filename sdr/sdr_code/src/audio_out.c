@@ -0,0 +1,165 @@
+#include <ch32v30x.h>
+#include <string.h>
+#include "audio_out.h"
+#include "dac_stream.h"
+#include "hardware.h"
+#include "spsc_ring.h"
+#include "prof.h"
+
+#define FILL_TARGET (AUDIO_RING_SIZE / 4)
+#define GATE_BLOCKS (AUDIO_GATE_MS * (AUDIO_RATE / 1000) / (AUDIO_DAC_LENGTH / 2))
+
+static u32 DAC_Audio_Buffer[AUDIO_DAC_LENGTH];
+
+static int16_t ring_data[AUDIO_RING_SIZE];
+static spsc_ring_t ring;        // Audio_Write produces, the DAC interrupt consumes
+
+static u32 source_rate;
+static u32 nominal_step;        // source samples per DAC sample, Q16
+static u32 phase;               // Q16 position between x0 and x1
+static int16_t x0, x1;
+static u32 fill_avg;            // ring fill, Q8, low-passed
+static u8 primed;                // ring has reached FILL_TARGET since the last underrun
+static u16 quiet_blocks;
+static u8 amplifier_on;
+static volatile u32 underruns;
+static volatile u32 overruns;
+
+static void Audio_Fill(u32 *samples, u16 count, void *context) {
+    u16 fill = spsc_count(&ring);
+    u32 index = 0, avail = 0, taken = 0;
+    int32_t error;
+    u32 step;
+    int32_t peak = 0;
+    PROF_BEGIN(PROF_AUDIO_FILL);
+
+    /* Hold the output until there is a cushion to play from */
+    if (!primed && fill >= FILL_TARGET)
+        primed = 1;
+
+    /* Trim the ratio by up to +-0.4% to hold the ring at a quarter full */
+    fill_avg += ((int32_t)fill * 256 - (int32_t)fill_avg) >> 5;
+    error = (int32_t)(fill_avg >> 8) - FILL_TARGET;
+    if (error > FILL_TARGET)
+        error = FILL_TARGET;
+    step = primed ? nominal_step + (((int32_t)(nominal_step >> 8) * error) >> 7) : 0;
+
+    for (u16 k = 0; k < count; k++) {
+        while (phase >= 0x10000) {
+            phase -= 0x10000;
+            x0 = x1;
+            if (!avail) {
+                /* Span used up or wrapped: hand it back and fetch the next */
+                spsc_release(&ring, taken);
+                taken = 0;
+                avail = spsc_read_span(&ring, &index);
+            }
+            if (avail) {
+                x1 = ring_data[index++];
+                avail--;
+                taken++;
+            } else {
+                /* Ran dry: hold the last sample until the ring refills */
+                underruns++;
+                primed = 0;
+                step = 0;
+                phase = 0;
+            }
+        }
+        int16_t y = x0 + (int32_t)(((int64_t)(x1 - x0) * phase) >> 16);
+        int32_t a = y < 0 ? -(int32_t)y : y;
+        if (a > peak)
+            peak = a;
+        samples[k] = DAC_IQ((y >> 4) + 2048, 2048);
+        phase += step;
+    }
+    spsc_release(&ring, taken);
+
+    /* Amplifier gating on silence */
+    if (peak >= AUDIO_SILENCE) {
+        quiet_blocks = 0;
+        if (!amplifier_on) {
+            AudioEnable();
+            amplifier_on = 1;
+        }
+    } else if (amplifier_on && ++quiet_blocks >= GATE_BLOCKS) {
+        AudioShutdown();
+        amplifier_on = 0;
+    }
+    PROF_END(PROF_AUDIO_FILL);
+}
+
+/*********************************************************************
+ * @fn      Audio_Start
+ *
+ * @brief   Takes over the DAC stream for audio at AUDIO_RATE.
+ *
+ * @param   rate - sample rate of the data passed to Audio_Write
+ *
+ * @return  none
+ */
+void Audio_Start(u32 rate) {
+    source_rate = rate;
+    nominal_step = (u32)(((uint64_t)rate << 16) / AUDIO_RATE);
+    phase = 0;
+    x0 = x1 = 0;
+    spsc_init(&ring, AUDIO_RING_SIZE);
+    primed = 0;
+    fill_avg = FILL_TARGET * 256;
+    quiet_blocks = 0;
+    amplifier_on = 0;
+    underruns = 0;
+    overruns = 0;
+    AudioShutdown();
+
+    DAC_Stream_Start(DAC_Audio_Buffer, AUDIO_DAC_LENGTH, Audio_Fill, 0);
+    DAC_Timer_Init(SystemCoreClock / AUDIO_RATE - 1, 0);
+}
+
+void Audio_Stop(void) {
+    DAC_Stream_Stop();
+    AudioShutdown();
+    amplifier_on = 0;
+}
+
+/* Queue demodulated samples; returns how many fitted, the rest are dropped */
+u16 Audio_Write(const int16_t *samples, u16 n) {
+    u16 space = spsc_space(&ring);
+    u16 done = 0;
+
+    if (n > space) {
+        overruns++;
+        n = space;
+    }
+    /* At most two spans: up to the end of the array, then the wrapped part */
+    while (done < n) {
+        u32 index, span = spsc_write_span(&ring, &index);
+
+        if (span > (u32)(n - done))
+            span = n - done;
+        memcpy(&ring_data[index], &samples[done], span * sizeof(int16_t));
+        spsc_commit(&ring, span);
+        done += span;
+    }
+    return n;
+}
+
+/* Ring delay at the source rate plus one full DAC buffer */
+u32 Audio_Latency_Us(void) {
+    if (!source_rate)
+        return 0;
+    return (u32)((uint64_t)(fill_avg >> 8) * 1000000 / source_rate) +
+           (u32)AUDIO_DAC_LENGTH * 1000000 / AUDIO_RATE;
+}
+
+u32 Audio_Underruns(void) {
+    return underruns;
+}
+
+u32 Audio_Overruns(void) {
+    return overruns;
+}
+
+u8 Audio_Amplifier_On(void) {
+    return amplifier_on;
+}
@@ -0,0 +1,34 @@
+/*
+	MS5351M band plan register table.
+
+	Generated by scripts/gen_band_plan.py - do not edit by hand.
+*/
+
+#include "band_plan.h"
+
+const band_plan_t BAND_PLAN[] = {
+	/* 160m: N=334 a=24 b0=359 c=7486 step=9.998704 Hz, no PHOFF quadrature */
+	{   1800000,   1950000, 334,   0, 24,   7486,  1286085, { 0x00, 0x01, 0x00, 0xA5, 0x00, 0x00, 0x00, 0x00 } },
+	/* 80m: N=172 a=24 b0=1162 c=14535 step=9.999920 Hz, no PHOFF quadrature */
+	{   3500000,   3900000, 172,   0, 24,  14535,  2497094, { 0x00, 0x01, 0x00, 0x54, 0x00, 0x00, 0x00, 0x00 } },
+	/* 40m: N=86 a=24 b0=2325 c=29070 step=9.999920 Hz */
+	{   7000000,   7300000,  86,  86, 24,  29070,  4994188, { 0x00, 0x01, 0x00, 0x29, 0x00, 0x00, 0x00, 0x00 } },
+	/* 30m: N=60 a=24 b0=10000 c=41667 step=9.999920 Hz */
+	{  10100000,  10150000,  60,  60, 24,  41667,  7158336, { 0x00, 0x01, 0x00, 0x1C, 0x00, 0x00, 0x00, 0x00 } },
+	/* 20m: N=44 a=24 b0=36364 c=56819 step=9.999856 Hz */
+	{  14000000,  14350000,  44,  44, 24,  56819,  9761430, { 0x00, 0x01, 0x00, 0x14, 0x00, 0x00, 0x00, 0x00 } },
+	/* 17m: N=34 a=24 b0=42094 c=73530 step=9.999920 Hz */
+	{  18068000,  18168000,  34,  34, 24,  73530, 12632358, { 0x00, 0x01, 0x00, 0x0F, 0x00, 0x00, 0x00, 0x00 } },
+	/* 15m: N=30 a=25 b0=16666 c=83334 step=9.999920 Hz */
+	{  21000000,  21450000,  30,  30, 25,  83334, 14316672, { 0x00, 0x01, 0x00, 0x0D, 0x00, 0x00, 0x00, 0x00 } },
+	/* 12m: N=26 a=25 b0=85153 c=96154 step=9.999984 Hz */
+	{  24890000,  24990000,  26,  26, 25,  96154, 16519131, { 0x00, 0x01, 0x00, 0x0B, 0x00, 0x00, 0x00, 0x00 } },
+	/* 10m: N=22 a=24 b0=72727 c=113637 step=9.999944 Hz */
+	{  28000000,  29700000,  22,  22, 24, 113637, 19522688, { 0x00, 0x01, 0x00, 0x09, 0x00, 0x00, 0x00, 0x00 } },
+	/* 6m: N=12 a=24 b0=0 c=208334 step=9.999968 Hz */
+	{  50000000,  51000000,  12,  12, 24, 208334, 35791509, { 0x00, 0x01, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00 } },
+	/* 2m: N=6 a=34 b0=233333 c=416667 step=9.999992 Hz */
+	{ 144000000, 148000000,   6,   6, 34, 416667, 71582846, { 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00 } },
+};
+
+const u8 BAND_PLAN_COUNT = sizeof(BAND_PLAN) / sizeof(BAND_PLAN[0]);
@@ -0,0 +1,153 @@
+/*
+	Goertzel-bank CW decoder with adaptive threshold and timing.
+*/
+#include <math.h>
+#include "cw_decoder.h"
+
+#define DOT_MIN  (2 << 4)       // 10.7 ms: about 110 WPM
+#define DOT_MAX  (40 << 4)      // 213 ms: about 6 WPM
+
+/* Index 1 is the root; a dot appends 0, a dash 1. '*' is not a character. */
+static const char MORSE[128] =
+	"**ETIANMSURWDKGOHVF*L*PJBXCYZQ**"
+	"54*3***2**+****16=/*****7***8*90"
+	"************?********.**********"
+	"*******************,************";
+
+void cw_decoder_init(cw_decoder_t *cw, uint32_t sample_rate, uint32_t pitch_hz) {
+	for (uint8_t b = 0; b < CW_BINS; b++) {
+		int32_t f = (int32_t)pitch_hz + ((int32_t)b - CW_BINS / 2) * CW_BIN_SPACING;
+		cw->coeff[b] = 2.0f * cosf(6.2831853f * f / sample_rate);
+		cw->s1[b] = 0;
+		cw->s2[b] = 0;
+	}
+	cw->count = 0;
+	cw->mark_level = 0;
+	cw->space_level = 0;
+	cw->key = 0;
+	cw->run = 0;
+	/* Start at 20 WPM: 60 ms dots */
+	cw->dot = (uint16_t)(((uint64_t)60 * sample_rate << 4) / (1000 * CW_BLOCK));
+	cw->code = 1;
+	cw->word_pending = 0;
+	spsc_init(&cw->text_ring, CW_TEXT_SIZE);
+}
+
+static void cw_put(cw_decoder_t *cw, char c) {
+	int32_t i = spsc_push_index(&cw->text_ring);
+
+	if (i >= 0) {
+		cw->text[i] = c;
+		spsc_commit(&cw->text_ring, 1);
+	}
+}
+
+char cw_decoder_getc(cw_decoder_t *cw) {
+	int32_t i = spsc_pop_index(&cw->text_ring);
+	char c;
+
+	if (i < 0)
+		return 0;
+	c = cw->text[i];
+	spsc_release(&cw->text_ring, 1);
+	return c;
+}
+
+static void cw_end_character(cw_decoder_t *cw) {
+	if (cw->code > 1) {
+		if (cw->word_pending)
+			cw_put(cw, ' ');
+		cw_put(cw, cw->code < 128 ? MORSE[cw->code] : '*');
+	}
+	cw->code = 1;
+	cw->word_pending = 0;
+}
+
+/* A mark of len blocks just ended */
+static void cw_mark(cw_decoder_t *cw, uint16_t len) {
+	uint32_t len_q4 = (uint32_t)len << 4;
+	int32_t dot = cw->dot;
+
+	if (len_q4 < 2 * (uint32_t)dot) {
+		cw->code = cw->code < 128 ? cw->code * 2 : 128;
+		dot += ((int32_t)len_q4 - dot) / 4;
+	} else {
+		cw->code = cw->code < 128 ? cw->code * 2 + 1 : 128;
+		dot += ((int32_t)len_q4 / 3 - dot) / 4;
+	}
+	if (dot < DOT_MIN)
+		dot = DOT_MIN;
+	if (dot > DOT_MAX)
+		dot = DOT_MAX;
+	cw->dot = (uint16_t)dot;
+}
+
+/* One block's tone power */
+static void cw_decide(cw_decoder_t *cw, float power) {
+	float threshold;
+	uint8_t key;
+
+	/* Log-domain midpoint of the two levels, with a floor against silence */
+	threshold = sqrtf((cw->mark_level + 1.0f) * (cw->space_level + 1.0f));
+	key = power > threshold && cw->mark_level > 4.0f * cw->space_level;
+
+	if (power > threshold)
+		cw->mark_level += 0.25f * (power - cw->mark_level);
+	else
+		cw->space_level += 0.25f * (power - cw->space_level);
+	/* Let the mark level fall after a fade or the end of a signal */
+	cw->mark_level -= 0.005f * (cw->mark_level - cw->space_level);
+
+	if (key == cw->key) {
+		if (cw->run < 0xFFFF)
+			cw->run++;
+		/* Spaces end characters and words as soon as they are long enough */
+		if (!key) {
+			uint32_t run_q4 = (uint32_t)cw->run << 4;
+
+			if (cw->code > 1 && run_q4 > 2 * (uint32_t)cw->dot)
+				cw_end_character(cw);
+			if (run_q4 > 5 * (uint32_t)cw->dot)
+				cw->word_pending = 1;
+		}
+		return;
+	}
+
+	if (cw->key)
+		cw_mark(cw, cw->run);
+	cw->key = key;
+	cw->run = 1;
+}
+
+void cw_decoder_process(cw_decoder_t *cw, const int16_t *audio, uint16_t n) {
+	for (uint16_t k = 0; k < n; k++) {
+		float x = audio[k] * (1.0f / 32768.0f);
+
+		for (uint8_t b = 0; b < CW_BINS; b++) {
+			float s = x + cw->coeff[b] * cw->s1[b] - cw->s2[b];
+			cw->s2[b] = cw->s1[b];
+			cw->s1[b] = s;
+		}
+
+		if (++cw->count < CW_BLOCK)
+			continue;
+		cw->count = 0;
+
+		float best = 0;
+		for (uint8_t b = 0; b < CW_BINS; b++) {
+			float s1 = cw->s1[b], s2 = cw->s2[b];
+			float p = s1 * s1 + s2 * s2 - cw->coeff[b] * s1 * s2;
+			if (p > best)
+				best = p;
+			cw->s1[b] = 0;
+			cw->s2[b] = 0;
+		}
+		cw_decide(cw, best);
+	}
+}
+
+/* PARIS: a dot is 1200 / WPM ms */
+uint8_t cw_decoder_wpm(const cw_decoder_t *cw, uint32_t sample_rate) {
+	uint32_t dot_us = (uint32_t)((uint64_t)cw->dot * CW_BLOCK * 1000000 / sample_rate >> 4);
+	return dot_us ? (uint8_t)(1200000 / dot_us) : 0;
+}
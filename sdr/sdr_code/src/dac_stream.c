@@ -0,0 +1,130 @@
+#include <ch32v30x.h>
+#include "dac_stream.h"
+#include "hardware.h"
+
+void DMA2_Channel3_IRQHandler(void) __attribute__((interrupt()));
+
+static u32 *stream_buffer;
+static u16 half_length;
+static dac_stream_fill_t stream_fill;
+static void *stream_context;
+
+static u32 *volatile free_half;     // half waiting for the producer, 0 if none
+static volatile u32 blocks;         // halves refilled
+static volatile u32 underruns;      // halves replayed because the producer was late
+
+/*********************************************************************
+ * @fn      DAC_Stream_Start
+ *
+ * @brief   Starts looping buffer through the dual DAC. DAC_Dual_Initialize and
+ *          DAC_Timer_Init set up the converters and the sample rate.
+ *
+ * @param   buffer - DAC_IQ() words, length entries
+ *          length - total samples, even; each half is length / 2
+ *          fill - producer run in the DMA interrupt, or 0 to poll
+ *          context - passed to fill
+ *
+ * @return  none
+ */
+void DAC_Stream_Start(u32 *buffer, u16 length, dac_stream_fill_t fill, void *context) {
+    NVIC_InitTypeDef NVIC_InitStructure = {0};
+
+    DAC_Stream_Stop();
+
+    stream_buffer = buffer;
+    half_length = length / 2;
+    stream_fill = fill;
+    stream_context = context;
+    free_half = 0;
+    blocks = 0;
+    underruns = 0;
+
+    /* Start from a full buffer, mid-scale if nobody fills it */
+    if (fill) {
+        fill(buffer, half_length, context);
+        fill(buffer + half_length, half_length, context);
+    } else {
+        for (u16 i = 0; i < length; i++)
+            buffer[i] = DAC_IQ(2048, 2048);
+    }
+
+    DAC_Dual_DMA_Init(buffer, length);
+    DMA_ITConfig(DMA2_Channel3, DMA_IT_HT | DMA_IT_TC, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = DMA2_Channel3_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
+void DAC_Stream_Stop(void) {
+    DMA_ITConfig(DMA2_Channel3, DMA_IT_HT | DMA_IT_TC, DISABLE);
+    DMA_Cmd(DMA2_Channel3, DISABLE);
+    free_half = 0;
+}
+
+/* Half that may be refilled now, or 0. Each acquired half must be released. */
+u32 *DAC_Stream_Acquire(void) {
+    return free_half;
+}
+
+void DAC_Stream_Release(u32 *half) {
+    /* If the next half came due meanwhile it stays pending */
+    NVIC_DisableIRQ(DMA2_Channel3_IRQn);
+    if (free_half == half)
+        free_half = 0;
+    NVIC_EnableIRQ(DMA2_Channel3_IRQn);
+    blocks++;
+}
+
+u16 DAC_Stream_HalfLength(void) {
+    return half_length;
+}
+
+u32 DAC_Stream_Blocks(void) {
+    return blocks;
+}
+
+u32 DAC_Stream_Underruns(void) {
+    return underruns;
+}
+
+/*********************************************************************
+ * @fn      DMA2_Channel3_IRQHandler
+ *
+ * @brief   HT: the first half has been played, TC: the second half.
+ *
+ * @return  none
+ */
+void DMA2_Channel3_IRQHandler(void) {
+    u32 *half;
+    u32 other;
+
+    if (DMA_GetITStatus(DMA2_IT_HT3) != RESET) {
+        DMA_ClearITPendingBit(DMA2_IT_HT3);
+        half = stream_buffer;
+        other = DMA2_IT_TC3;
+    } else if (DMA_GetITStatus(DMA2_IT_TC3) != RESET) {
+        DMA_ClearITPendingBit(DMA2_IT_TC3);
+        half = stream_buffer + half_length;
+        other = DMA2_IT_HT3;
+    } else {
+        DMA_ClearITPendingBit(DMA2_IT_GL3);
+        return;
+    }
+
+    if (stream_fill) {
+        stream_fill(half, half_length, stream_context);
+        blocks++;
+        /* The other half already finished too: DMA wrapped onto this half before the fill was done */
+        if (DMA_GetITStatus(other) != RESET)
+            underruns++;
+        return;
+    }
+
+    /* The other half was never released: DMA is about to replay stale samples */
+    if (free_half)
+        underruns++;
+    free_half = half;
+}
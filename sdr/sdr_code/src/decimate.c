@@ -0,0 +1,163 @@
+/*
+	In-place I/Q decimation: CIC, half-band and general FIR stages.
+*/
+#include <string.h>
+#include "decimate.h"
+
+static inline int16_t saturate(int32_t x) {
+	if (x > 32767)
+		return 32767;
+	if (x < -32768)
+		return -32768;
+	return (int16_t)x;
+}
+
+void cic_init(cic_t *cic, uint8_t order, uint16_t rate) {
+	uint8_t bits = 0;
+
+	memset(cic, 0, sizeof(*cic));
+	if (order > CIC_MAX_ORDER)
+		order = CIC_MAX_ORDER;
+	while ((1u << bits) < rate)
+		bits++;
+	cic->order = order;
+	cic->rate = rate;
+	cic->shift = order * bits;
+}
+
+uint16_t cic_process(cic_t *cic, int16_t *iq, uint16_t n) {
+	uint16_t out = 0;
+
+	for (uint16_t k = 0; k < n; k++) {
+		for (uint8_t ch = 0; ch < 2; ch++) {
+			uint32_t x = (uint32_t)(int32_t)iq[2 * k + ch];
+			uint32_t *integ = cic->integ[ch];
+
+			for (uint8_t s = 0; s < cic->order; s++)
+				x = integ[s] += x;
+		}
+
+		if (++cic->count < cic->rate)
+			continue;
+		cic->count = 0;
+
+		for (uint8_t ch = 0; ch < 2; ch++) {
+			uint32_t x = cic->integ[ch][cic->order - 1];
+			uint32_t *comb = cic->comb[ch];
+
+			for (uint8_t s = 0; s < cic->order; s++) {
+				uint32_t y = x - comb[s];
+				comb[s] = x;
+				x = y;
+			}
+			iq[2 * out + ch] = saturate((int32_t)x >> cic->shift);
+		}
+		out++;
+	}
+	return out;
+}
+
+void halfband_init(halfband_t *hb, const int16_t *taps, uint8_t per_side) {
+	memset(hb, 0, sizeof(*hb));
+	hb->taps = taps;
+	hb->per_side = per_side;
+	hb->len = 4 * per_side - 1;
+}
+
+/*
+	The delay line is stored twice back to back so the newest len samples are
+	always contiguous at delay[pos..pos+len-1], newest first.
+*/
+uint16_t halfband_process(halfband_t *hb, int16_t *iq, uint16_t n) {
+	uint8_t len = hb->len, centre = len / 2;
+	uint16_t out = 0;
+
+	for (uint16_t k = 0; k < n; k++) {
+		hb->pos = hb->pos ? hb->pos - 1 : len - 1;
+		for (uint8_t ch = 0; ch < 2; ch++)
+			hb->delay[ch][hb->pos] = hb->delay[ch][hb->pos + len] = iq[2 * k + ch];
+
+		hb->phase ^= 1;
+		if (hb->phase)
+			continue;
+
+		for (uint8_t ch = 0; ch < 2; ch++) {
+			const int16_t *w = &hb->delay[ch][hb->pos];
+			int32_t acc = (int32_t)w[centre] << 14;
+
+			for (uint8_t j = 0; j < hb->per_side; j++)
+				acc += hb->taps[j] * (w[centre - 2 * j - 1] + w[centre + 2 * j + 1]);
+			iq[2 * out + ch] = saturate((acc + (1 << 14)) >> 15);
+		}
+		out++;
+	}
+	return out;
+}
+
+void fir_init(fir_t *fir, const int16_t *taps, uint8_t len, uint8_t decim) {
+	memset(fir, 0, sizeof(*fir));
+	fir->taps = taps;
+	fir->len = len > FIR_MAX_TAPS ? FIR_MAX_TAPS : len;
+	fir->decim = decim ? decim : 1;
+}
+
+uint16_t fir_process(fir_t *fir, int16_t *iq, uint16_t n) {
+	uint8_t len = fir->len;
+	uint16_t out = 0;
+
+	for (uint16_t k = 0; k < n; k++) {
+		fir->pos = fir->pos ? fir->pos - 1 : len - 1;
+		for (uint8_t ch = 0; ch < 2; ch++)
+			fir->delay[ch][fir->pos] = fir->delay[ch][fir->pos + len] = iq[2 * k + ch];
+
+		if (++fir->phase < fir->decim)
+			continue;
+		fir->phase = 0;
+
+		for (uint8_t ch = 0; ch < 2; ch++) {
+			const int16_t *w = &fir->delay[ch][fir->pos];
+			int32_t acc = 1 << 14;
+
+			for (uint8_t j = 0; j < len; j++)
+				acc += fir->taps[j] * w[j];
+			iq[2 * out + ch] = saturate(acc >> 15);
+		}
+		out++;
+	}
+	return out;
+}
+
+void decimator_init(decimator_t *d, uint8_t cic_order, uint16_t cic_rate, uint8_t halfbands,
+                    const int16_t *fir_taps, uint8_t fir_len, uint8_t fir_decim) {
+	if (halfbands > DECIMATE_MAX_HALFBANDS)
+		halfbands = DECIMATE_MAX_HALFBANDS;
+
+	cic_init(&d->cic, cic_order, cic_rate);
+	d->halfbands = halfbands;
+	for (uint8_t s = 0; s < halfbands; s++) {
+		if (s == halfbands - 1)
+			halfband_init(&d->hb[s], HALFBAND_LONG, HALFBAND_LONG_PER_SIDE);
+		else
+			halfband_init(&d->hb[s], HALFBAND_SHORT, HALFBAND_SHORT_PER_SIDE);
+	}
+	fir_init(&d->fir, fir_taps, fir_len, fir_decim);
+}
+
+void decimator_init_default(decimator_t *d) {
+	decimator_init(d, DECIMATE_DEFAULT_CIC_ORDER, DECIMATE_DEFAULT_CIC_RATE, DECIMATE_DEFAULT_HALFBANDS,
+	               DECIMATE_COMP_TAPS, DECIMATE_COMP_LEN, 1);
+}
+
+uint16_t decimator_process(decimator_t *d, int16_t *iq, uint16_t n) {
+	n = cic_process(&d->cic, iq, n);
+	for (uint8_t s = 0; s < d->halfbands; s++)
+		n = halfband_process(&d->hb[s], iq, n);
+	if (d->fir.taps)
+		n = fir_process(&d->fir, iq, n);
+	return n;
+}
+
+/* Input rate / output rate */
+uint32_t decimator_ratio(const decimator_t *d) {
+	return ((uint32_t)d->cic.rate << d->halfbands) * (d->fir.taps ? d->fir.decim : 1);
+}
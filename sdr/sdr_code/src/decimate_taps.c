@@ -0,0 +1,25 @@
+/*
+	Q15 tables for the decimation chain (768000 Hz / 16 / 4 = 12000 Hz).
+
+	Generated by scripts/gen_decimate_taps.py - do not edit by hand.
+*/
+
+#include "decimate.h"
+
+/* Odd taps h1, h3, ... of 11 and 23 tap half-bands; the centre tap is 16384 */
+const int16_t HALFBAND_SHORT[3] = {
+	  9340,  -1179,     31,
+};
+
+const int16_t HALFBAND_LONG[6] = {
+	 10192,  -2825,   1151,   -434,    122,    -14,
+};
+
+/* 12000 Hz channel filter, flat to 4000 Hz after CIC order 4 / 16 droop, stop from 5000 Hz */
+const int16_t DECIMATE_COMP_TAPS[31] = {
+	    -2,     11,    -19,      1,     71,   -175,    204,     -2,
+	  -477,    995,  -1020,    -15,   2265,  -5140,   7171,  25032,
+	  7171,  -5140,   2265,    -15,  -1020,    995,   -477,     -2,
+	   204,   -175,     71,      1,    -19,     11,     -2,
+};
+
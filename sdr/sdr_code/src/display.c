@@ -0,0 +1,77 @@
+// ===================================================================================
+// Partial OLED refresh on top of the u8g2 full frame buffer
+// ===================================================================================
+//
+// The SSD1306 full buffer holds one 128 byte row per 8 pixel page, so tile (tx, ty)
+// is the 8 bytes at buf[ty * 128 + tx * 8]. A copy of the last transmitted frame is
+// kept to find the tiles that changed; each run of changed tiles in a page costs one
+// u8g2_UpdateDisplayArea() call. The display start line goes out after the data, so
+// a scrolled view never shows rows that have not been rewritten yet.
+
+#include <string.h>
+#include "display.h"
+#include "prof.h"
+
+#define TILE_BYTES 8
+#define ROW_BYTES  (DISPLAY_TILE_COLS * TILE_BYTES)
+#define LINES      (DISPLAY_TILE_ROWS * 8)
+
+static uint8_t sent[DISPLAY_TILE_ROWS * ROW_BYTES];
+static uint8_t sent_valid;
+static uint8_t start_line, sent_start_line;
+
+void Display_Invalidate(void) {
+  sent_valid = 0;
+}
+
+void Display_Set_Start_Line(uint8_t line) {
+  start_line = line & (LINES - 1);
+}
+
+static void Display_Send_Start_Line(u8g2_t *u8g2) {
+  u8x8_t *u8x8 = u8g2_GetU8x8(u8g2);
+
+  u8x8_cad_StartTransfer(u8x8);
+  u8x8_cad_SendCmd(u8x8, 0x40 | start_line);
+  u8x8_cad_EndTransfer(u8x8);
+  sent_start_line = start_line;
+}
+
+uint8_t Display_Flush(u8g2_t *u8g2) {
+  uint8_t *buf = u8g2_GetBufferPtr(u8g2);
+  uint8_t tiles = 0;
+
+  if(!sent_valid) {
+    PROF_BEGIN(PROF_SEND_BUFFER);
+    u8g2_SendBuffer(u8g2);
+    PROF_END(PROF_SEND_BUFFER);
+    memcpy(sent, buf, sizeof(sent));
+    sent_valid = 1;
+    Display_Send_Start_Line(u8g2);
+    return DISPLAY_TILE_COLS * DISPLAY_TILE_ROWS;
+  }
+
+  for(uint8_t ty = 0; ty < DISPLAY_TILE_ROWS; ty++) {
+    uint8_t *row = buf + ty * ROW_BYTES;
+    uint8_t *old = sent + ty * ROW_BYTES;
+    uint8_t tx = 0;
+
+    while(tx < DISPLAY_TILE_COLS) {
+      if(memcmp(row + tx * TILE_BYTES, old + tx * TILE_BYTES, TILE_BYTES) == 0) {
+        tx++;
+        continue;
+      }
+      uint8_t first = tx;
+      while(tx < DISPLAY_TILE_COLS &&
+            memcmp(row + tx * TILE_BYTES, old + tx * TILE_BYTES, TILE_BYTES) != 0)
+        tx++;
+
+      u8g2_UpdateDisplayArea(u8g2, first, ty, tx - first, 1);
+      memcpy(old + first * TILE_BYTES, row + first * TILE_BYTES, (tx - first) * TILE_BYTES);
+      tiles += tx - first;
+    }
+  }
+  if(start_line != sent_start_line)
+    Display_Send_Start_Line(u8g2);
+  return tiles;
+}
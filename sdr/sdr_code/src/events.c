@@ -0,0 +1,103 @@
+#include <ch32v30x.h>
+#include "events.h"
+#include "keys.h"
+
+void TIM4_IRQHandler(void) __attribute__((interrupt()));
+
+static volatile u32 pending;
+static volatile u32 millis;
+
+static u16 timer_period[EVENT_TIMERS];
+static volatile u16 timer_left[EVENT_TIMERS];  // 0: stopped
+
+/*********************************************************************
+ * @fn      Event_Init
+ *
+ * @brief   Starts the 1 kHz TIM4 tick behind Event_Millis, the event
+ *          timers and key sampling.
+ *
+ * @return  none
+ */
+void Event_Init(void) {
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseInitStructure = {0};
+    NVIC_InitTypeDef NVIC_InitStructure = {0};
+
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM4, ENABLE);
+
+    /* 144 MHz / 144 = 1 MHz count, 1000 counts per tick */
+    TIM_TimeBaseInitStructure.TIM_Period = 1000 - 1;
+    TIM_TimeBaseInitStructure.TIM_Prescaler = SystemCoreClock / 1000000 - 1;
+    TIM_TimeBaseInitStructure.TIM_ClockDivision = TIM_CKD_DIV1;
+    TIM_TimeBaseInitStructure.TIM_CounterMode = TIM_CounterMode_Up;
+    TIM_TimeBaseInit(TIM4, &TIM_TimeBaseInitStructure);
+    TIM_ITConfig(TIM4, TIM_IT_Update, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = TIM4_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    TIM_Cmd(TIM4, ENABLE);
+}
+
+/* Any context; amoor.w on the A extension */
+void Event_Post(u8 event) {
+    __atomic_fetch_or(&pending, EVENT_BIT(event), __ATOMIC_RELEASE);
+}
+
+/*********************************************************************
+ * @fn      Event_Wait
+ *
+ * @brief   Sleeps until at least one event is pending.
+ *
+ * @return  the pending events (EVENT_BIT set), now cleared
+ */
+u32 Event_Wait(void) {
+    u32 events;
+
+    /*
+     * Check and sleep with interrupts masked so a post between the two cannot
+     * be missed: WFI still wakes on a pending interrupt, which then runs as
+     * soon as they are unmasked.
+     */
+    __disable_irq();
+    while (!pending) {
+        __WFI();
+        __enable_irq();
+        __disable_irq();
+    }
+    events = __atomic_exchange_n(&pending, 0, __ATOMIC_ACQUIRE);
+    __enable_irq();
+    return events;
+}
+
+/* Post EVENT_TIMER_0 + timer every period_ms, first one period from now */
+void Event_Timer_Start(u8 timer, u16 period_ms) {
+    if (timer >= EVENT_TIMERS || !period_ms)
+        return;
+    timer_period[timer] = period_ms;
+    timer_left[timer] = period_ms;
+}
+
+void Event_Timer_Stop(u8 timer) {
+    if (timer < EVENT_TIMERS)
+        timer_left[timer] = 0;
+}
+
+u32 Event_Millis(void) {
+    return millis;
+}
+
+void TIM4_IRQHandler(void) {
+    TIM_ClearITPendingBit(TIM4, TIM_IT_Update);
+    millis++;
+    Keys_Sample();
+
+    for (u8 i = 0; i < EVENT_TIMERS; i++) {
+        if (timer_left[i] && --timer_left[i] == 0) {
+            timer_left[i] = timer_period[i];
+            Event_Post(EVENT_TIMER_0 + i);
+        }
+    }
+}
@@ -0,0 +1,112 @@
+/*
+	Radix-4 (with a radix-2 stage for odd powers of two) Q15 FFT.
+*/
+#include "fft.h"
+#include "nco.h"
+
+static void bit_reverse(int16_t *iq, uint16_t n) {
+	uint16_t j = 0;
+
+	for (uint16_t i = 0; i < n - 1; i++) {
+		if (i < j) {
+			int16_t t;
+			t = iq[2 * i]; iq[2 * i] = iq[2 * j]; iq[2 * j] = t;
+			t = iq[2 * i + 1]; iq[2 * i + 1] = iq[2 * j + 1]; iq[2 * j + 1] = t;
+		}
+		uint16_t bit = n >> 1;
+		while (j & bit) {
+			j ^= bit;
+			bit >>= 1;
+		}
+		j |= bit;
+	}
+}
+
+/* (re, im) *= (c, -s), i.e. by exp(-j theta) with c = cos, s = sin in Q15 */
+#define CMUL(re, im, c, s) do {                                 \
+		int32_t _r = ((re) * (c) + (im) * (s) + 0x4000) >> 15;  \
+		int32_t _i = ((im) * (c) - (re) * (s) + 0x4000) >> 15;  \
+		(re) = _r;                                              \
+		(im) = _i;                                              \
+	} while (0)
+
+void fft_q15(int16_t *iq, uint16_t n) {
+	uint16_t span = 1;
+	uint8_t bits = 0;
+
+	while ((1u << bits) < n)
+		bits++;
+
+	bit_reverse(iq, n);
+
+	/* Odd power of two: one radix-2 stage (trivial twiddle) */
+	if (bits & 1) {
+		for (uint16_t k = 0; k < n; k += 2) {
+			int32_t ar = iq[2 * k], ai = iq[2 * k + 1];
+			int32_t br = iq[2 * k + 2], bi = iq[2 * k + 3];
+			iq[2 * k] = (ar + br) >> 1;
+			iq[2 * k + 1] = (ai + bi) >> 1;
+			iq[2 * k + 2] = (ar - br) >> 1;
+			iq[2 * k + 3] = (ai - bi) >> 1;
+		}
+		span = 2;
+	}
+
+	/* Radix-4: combine four sub-transforms of length span into one of 4 * span */
+	for (; span < n; span *= 4) {
+		uint32_t dphase = 0xFFFFFFFFu / (4u * span) + 1;    // 2^32 / (4 * span)
+
+		for (uint16_t j = 0; j < span; j++) {
+			uint32_t phase = dphase * j;
+			int32_t c1 = nco_cos(phase), s1 = nco_sin(phase);
+			int32_t c2 = nco_cos(2 * phase), s2 = nco_sin(2 * phase);
+			int32_t c3 = nco_cos(3 * phase), s3 = nco_sin(3 * phase);
+
+			for (uint16_t k = j; k < n; k += 4 * span) {
+				int16_t *a = &iq[2 * k];
+				int16_t *b = &iq[2 * (k + span)];
+				int16_t *c = &iq[2 * (k + 2 * span)];
+				int16_t *d = &iq[2 * (k + 3 * span)];
+				int32_t ar = a[0], ai = a[1];
+				int32_t br = b[0], bi = b[1];
+				int32_t cr = c[0], ci = c[1];
+				int32_t dr = d[0], di = d[1];
+
+				/* Bit reversal leaves the span-wide odd half in b, the 2*span one in c */
+				if (j) {
+					CMUL(br, bi, c2, s2);
+					CMUL(cr, ci, c1, s1);
+					CMUL(dr, di, c3, s3);
+				}
+
+				int32_t sr = ar + br, si = ai + bi;     // a + W^2j b
+				int32_t tr = ar - br, ti = ai - bi;     // a - W^2j b
+				int32_t ur = cr + dr, ui = ci + di;     // W^j c + W^3j d
+				int32_t vr = cr - dr, vi = ci - di;     // W^j c - W^3j d
+
+				a[0] = (sr + ur) >> 2;
+				a[1] = (si + ui) >> 2;
+				c[0] = (sr - ur) >> 2;
+				c[1] = (si - ui) >> 2;
+				/* X1 = t - j v, X3 = t + j v */
+				b[0] = (tr + vi) >> 2;
+				b[1] = (ti - vr) >> 2;
+				d[0] = (tr - vi) >> 2;
+				d[1] = (ti + vr) >> 2;
+			}
+		}
+	}
+}
+
+/* w[k] = sin^2(pi k / n) */
+void fft_window_hann(int16_t *iq, uint16_t n) {
+	uint32_t dphase = 0xFFFFFFFFu / (2u * n) + 1;       // 2^32 / (2n): half a cycle over the block
+
+	for (uint16_t k = 0; k < n; k++) {
+		int32_t s = nco_sin(dphase * k);
+		int32_t w = (s * s + 0x4000) >> 15;
+
+		iq[2 * k] = (int16_t)((iq[2 * k] * w + 0x4000) >> 15);
+		iq[2 * k + 1] = (int16_t)((iq[2 * k + 1] * w + 0x4000) >> 15);
+	}
+}
@@ -0,0 +1,99 @@
+/*
+	Polar FM discriminator with a fast fixed-point atan2 and de-emphasis.
+*/
+#include "fm_demod.h"
+
+static inline uint32_t read_cycles(void) {
+#if defined(__riscv)
+	uint32_t c;
+	__asm__ volatile ("csrr %0, mcycle" : "=r"(c));
+	return c;
+#else
+	return 0;
+#endif
+}
+
+/*
+	atan(z) / pi for z = 0..1 in Q15:
+	z/4 + z(1-z)(0.0779 + 0.0211z), max error 0.0015 rad
+*/
+static inline int32_t atan_unit(int32_t z) {
+	int32_t t = (z * (32768 - z)) >> 15;
+	int32_t p = 2552 + ((691 * z) >> 15);
+	return (z >> 2) + ((t * p) >> 15);
+}
+
+int16_t fm_atan2(int32_t y, int32_t x) {
+	uint32_t ax = x < 0 ? -(uint32_t)x : (uint32_t)x;
+	uint32_t ay = y < 0 ? -(uint32_t)y : (uint32_t)y;
+	uint32_t hi = ax > ay ? ax : ay;
+	uint32_t lo = ax > ay ? ay : ax;
+	int32_t a;
+
+	if (hi == 0)
+		return 0;
+
+	/* Bring both below 2^16 so the ratio fits a 32 bit divide */
+	if (hi > 0xFFFF) {
+		int shift = 16 - __builtin_clz(hi);
+		hi >>= shift;
+		lo >>= shift;
+	}
+	a = atan_unit((int32_t)((lo << 15) / hi));
+
+	if (ay > ax)
+		a = 16384 - a;
+	if (x < 0)
+		a = 32768 - a;
+	if (y < 0)
+		a = -a;
+	return (int16_t)a;
+}
+
+/*
+	deviation_hz maps to full-scale audio; deemph_us is the de-emphasis time
+	constant (0 for none).
+*/
+void fm_demod_init(fm_demod_t *fm, uint32_t sample_rate, uint32_t deviation_hz, uint32_t deemph_us) {
+	/* Phase step at full deviation, 32768 = pi */
+	uint32_t step = (uint32_t)(((uint64_t)deviation_hz << 16) / sample_rate);
+
+	fm->prev_i = 0;
+	fm->prev_q = 0;
+	fm->gain = step ? (int32_t)((32767u << 8) / step) : 256;
+	fm->alpha = (int32_t)(32768ull * 1000000 / (1000000 + (uint64_t)sample_rate * deemph_us));
+	fm->deemph = 0;
+	fm->cycles_per_sample = 0;
+}
+
+void fm_demod_process(fm_demod_t *fm, const int16_t *iq, int16_t *audio, uint16_t n) {
+	uint32_t start = read_cycles();
+	int32_t pi = fm->prev_i, pq = fm->prev_q;
+	int32_t gain = fm->gain, alpha = fm->alpha, y = fm->deemph;
+
+	for (uint16_t k = 0; k < n; k++) {
+		int32_t i = iq[2 * k], q = iq[2 * k + 1];
+
+		/* z[n] * conj(z[n-1]), halved so full-scale inputs cannot overflow */
+		int32_t re = ((i * pi) >> 1) + ((q * pq) >> 1);
+		int32_t im = ((q * pi) >> 1) - ((i * pq) >> 1);
+		int32_t x = (fm_atan2(im, re) * gain) >> 8;
+
+		if (x > 32767)
+			x = 32767;
+		else if (x < -32768)
+			x = -32768;
+
+		y += (int32_t)(((int64_t)((x << 15) - y) * alpha) >> 15);
+		audio[k] = (int16_t)(y >> 15);
+
+		pi = i;
+		pq = q;
+	}
+
+	fm->prev_i = (int16_t)pi;
+	fm->prev_q = (int16_t)pq;
+	fm->deemph = y;
+	if (n)
+		fm->cycles_per_sample = (read_cycles() - start) / n;
+}
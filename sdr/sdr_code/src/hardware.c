@@ -1,5 +1,6 @@
 #include <ch32v30x.h>
 #include "hardware.h"
+#include "i2c1_queue.h"
 
 
 
@@ -69,6 +70,31 @@ void DAC_Initialize(void) {
 	DAC_DMACmd(DAC_Channel_1,ENABLE);
 }
 
+/*********************************************************************
+ * @fn      DAC_Dual_Initialize
+ *
+ * @brief   Enables DAC_I (channel 1, PA4) and DAC_Q (channel 2, PA5) for baseband.
+ *          Both channels latch on the same TIM8 TRGO edge, and only channel 1
+ *          requests DMA: each request moves one packed I/Q word into RD12BDHR.
+ *
+ * @return  none
+ */
+void DAC_Dual_Initialize(void) {
+    DAC_InitTypeDef  DAC_InitType = {0};
+
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_DAC, ENABLE);
+	DAC_InitType.DAC_Trigger=DAC_Trigger_T8_TRGO;
+	DAC_InitType.DAC_WaveGeneration=DAC_WaveGeneration_None;
+	DAC_InitType.DAC_OutputBuffer=DAC_OutputBuffer_Disable ;
+    DAC_Init(DAC_Channel_1,&DAC_InitType);
+    DAC_Init(DAC_Channel_2,&DAC_InitType);
+
+	DAC_Cmd(DAC_Channel_1, ENABLE);
+	DAC_Cmd(DAC_Channel_2, ENABLE);
+	DAC_DMACmd(DAC_Channel_1,ENABLE);
+	DAC_DMACmd(DAC_Channel_2,DISABLE);
+}
+
 
 
 /*********************************************************************
@@ -124,6 +150,38 @@ void DAC_DMA_Init(u16* dacbuff16bit_ptr, u32 buffsize) {
     DMA_Cmd(DMA2_Channel3, ENABLE);
 }
 
+/*********************************************************************
+ * @fn      DAC_Dual_DMA_Init
+ *
+ * @brief   Streams packed I/Q words (see DAC_IQ) to the dual DAC holding
+ *          register, so I and Q are always updated on the same sample.
+ *
+ * @param   iqbuff32bit_ptr - circular buffer of DAC_IQ(i, q) words
+ *          buffsize - number of I/Q samples
+ *
+ * @return  none
+ */
+void DAC_Dual_DMA_Init(u32* iqbuff32bit_ptr, u32 buffsize) {
+    DMA_InitTypeDef DMA_InitStructure={0};
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA2, ENABLE);
+
+    DMA_StructInit( &DMA_InitStructure);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (u32)&(DAC->RD12BDHR);
+    DMA_InitStructure.DMA_MemoryBaseAddr = (u32)iqbuff32bit_ptr;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+    DMA_InitStructure.DMA_BufferSize = buffsize;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Word;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_VeryHigh;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+
+    DMA_Init(DMA2_Channel3, &DMA_InitStructure);
+    DMA_Cmd(DMA2_Channel3, ENABLE);
+}
+
 void Synthesizer_Init(u32 bound, u16 address)
 {
     GPIO_InitTypeDef GPIO_InitStructure = {0};
@@ -155,5 +213,7 @@ void Synthesizer_Init(u32 bound, u16 address)
     I2C_AcknowledgeConfig(I2C1, ENABLE);
 
     while( I2C_GetFlagStatus( I2C1, I2C_FLAG_BUSY ) != RESET );
+
+    I2C1_Queue_Init();
 }
 
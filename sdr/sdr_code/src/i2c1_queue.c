@@ -0,0 +1,212 @@
+// ===================================================================================
+// Interrupt driven I2C1 master with a transaction queue
+// ===================================================================================
+//
+// Each transaction is START, address+W, register, then either the write payload and
+// STOP, or a repeated START, address+R and the read bytes. The state machine below is
+// advanced by the SB, ADDR, TXE, BTF and RXNE events (RM "I2C master mode").
+
+#include "i2c1_queue.h"
+
+void I2C1_EV_IRQHandler(void) __attribute__((interrupt()));
+void I2C1_ER_IRQHandler(void) __attribute__((interrupt()));
+
+#define I2C1_QUEUE_MASK (I2C1_QUEUE_LEN - 1)
+
+typedef struct {
+	u8 address;                     // 7 bit slave address
+	u8 reg;                         // register address, always sent first
+	u8 len;                         // payload length
+	u8 read;                        // 1: repeated start and read len bytes into dest
+	u8 *dest;
+	u8 data[I2C1_QUEUE_DATA_MAX];   // write payload, copied at submit time
+	i2c1_callback_t callback;       // called from interrupt context, may be 0
+	void *context;
+} i2c1_txn_t;
+
+static i2c1_txn_t queue[I2C1_QUEUE_LEN];
+static volatile u8 head;            // next transaction to run, advanced by the ISR
+static volatile u8 tail;            // next free slot, advanced by submitters
+static volatile u8 busy;
+static volatile u32 errors;
+
+static u8 rx_phase;                 // 0: sending register/payload, 1: reading
+static u8 pos;                      // payload bytes transferred so far
+
+/*********************************************************************
+ * @fn      I2C1_Queue_Init
+ *
+ * @brief   Enables the I2C1 event and error interrupts. I2C1 itself must
+ *          already be configured by Synthesizer_Init.
+ *
+ * @return  none
+ */
+void I2C1_Queue_Init(void) {
+    NVIC_InitTypeDef NVIC_InitStructure = {0};
+
+    head = tail = 0;
+    busy = 0;
+
+    NVIC_InitStructure.NVIC_IRQChannel = I2C1_EV_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    NVIC_InitStructure.NVIC_IRQChannel = I2C1_ER_IRQn;
+    NVIC_Init(&NVIC_InitStructure);
+
+    I2C_ITConfig(I2C1, I2C_IT_EVT | I2C_IT_ERR, ENABLE);
+}
+
+static void I2C1_Queue_Start(void) {
+    rx_phase = 0;
+    pos = 0;
+    I2C_GenerateSTART(I2C1, ENABLE);
+}
+
+static int I2C1_Queue_Submit(u8 address, u8 reg, const u8 *buf, u8 *dest, u8 len,
+                             i2c1_callback_t callback, void *context) {
+    if (buf != 0 && len > I2C1_QUEUE_DATA_MAX)
+        return -1;
+
+    /* Queue full: wait for the interrupt handler to retire a transaction */
+    while ((u8)(tail - head) == I2C1_QUEUE_LEN);
+
+    i2c1_txn_t *txn = &queue[tail & I2C1_QUEUE_MASK];
+    txn->address = address;
+    txn->reg = reg;
+    txn->len = len;
+    txn->read = (dest != 0);
+    txn->dest = dest;
+    for (u8 i = 0; buf != 0 && i < len; i++)
+        txn->data[i] = buf[i];
+    txn->callback = callback;
+    txn->context = context;
+
+    /* The ISR clears busy when it drains the queue, so publish and kick atomically */
+    NVIC_DisableIRQ(I2C1_EV_IRQn);
+    NVIC_DisableIRQ(I2C1_ER_IRQn);
+    tail++;
+    if (!busy) {
+        busy = 1;
+        I2C1_Queue_Start();
+    }
+    NVIC_EnableIRQ(I2C1_ER_IRQn);
+    NVIC_EnableIRQ(I2C1_EV_IRQn);
+    return 0;
+}
+
+// Queue a register write of len bytes (auto-incrementing from reg)
+int I2C1_Queue_Write(u8 address, u8 reg, const u8 *buf, u8 len, i2c1_callback_t callback, void *context) {
+    return I2C1_Queue_Submit(address, reg, buf, 0, len, callback, context);
+}
+
+// Queue a register read; dest must stay valid until the callback or a flush
+int I2C1_Queue_Read(u8 address, u8 reg, u8 *dest, u8 len, i2c1_callback_t callback, void *context) {
+    if (len == 0)
+        return -1;
+    return I2C1_Queue_Submit(address, reg, 0, dest, len, callback, context);
+}
+
+int I2C1_Queue_Idle(void) {
+    return !busy;
+}
+
+// Block until every queued transaction has completed
+void I2C1_Queue_Flush(void) {
+    while (busy);
+}
+
+u32 I2C1_Queue_Errors(void) {
+    return errors;
+}
+
+static void I2C1_Queue_Complete(u8 status) {
+    i2c1_txn_t *txn = &queue[head & I2C1_QUEUE_MASK];
+
+    I2C_ITConfig(I2C1, I2C_IT_BUF, DISABLE);
+    if (status != I2C1_OK)
+        errors++;
+    if (txn->callback)
+        txn->callback(status, txn->context);
+
+    head++;
+    if (head != tail)
+        I2C1_Queue_Start();
+    else
+        busy = 0;
+}
+
+void I2C1_EV_IRQHandler(void) {
+    i2c1_txn_t *txn = &queue[head & I2C1_QUEUE_MASK];
+    u16 star1 = I2C1->STAR1;
+
+    if (star1 & I2C_STAR1_SB) {
+        I2C_Send7bitAddress(I2C1, txn->address << 1,
+                            rx_phase ? I2C_Direction_Receiver : I2C_Direction_Transmitter);
+        return;
+    }
+
+    if (star1 & I2C_STAR1_ADDR) {
+        if (rx_phase) {
+            /* A single byte read must NACK and STOP before ADDR is cleared */
+            I2C_AcknowledgeConfig(I2C1, txn->len > 1 ? ENABLE : DISABLE);
+            (void)I2C1->STAR2;
+            if (txn->len == 1)
+                I2C_GenerateSTOP(I2C1, ENABLE);
+        } else {
+            (void)I2C1->STAR2;
+            I2C_SendData(I2C1, txn->reg);
+        }
+        if (rx_phase || !txn->read)
+            I2C_ITConfig(I2C1, I2C_IT_BUF, ENABLE);
+        return;
+    }
+
+    if (rx_phase) {
+        if (star1 & I2C_STAR1_RXNE) {
+            txn->dest[pos++] = I2C_ReceiveData(I2C1);
+            if (txn->len - pos == 1) {
+                I2C_AcknowledgeConfig(I2C1, DISABLE);
+                I2C_GenerateSTOP(I2C1, ENABLE);
+            }
+            if (pos == txn->len) {
+                I2C_AcknowledgeConfig(I2C1, ENABLE);
+                I2C1_Queue_Complete(I2C1_OK);
+            }
+        }
+        return;
+    }
+
+    if ((star1 & I2C_STAR1_TXE) && !txn->read && pos < txn->len) {
+        I2C_SendData(I2C1, txn->data[pos++]);
+        if (pos == txn->len)
+            I2C_ITConfig(I2C1, I2C_IT_BUF, DISABLE);   // wait for BTF on the last byte
+        return;
+    }
+
+    if (star1 & I2C_STAR1_BTF) {
+        if (txn->read) {
+            rx_phase = 1;
+            pos = 0;
+            I2C_GenerateSTART(I2C1, ENABLE);    // repeated start for the read phase
+        } else {
+            I2C_GenerateSTOP(I2C1, ENABLE);
+            I2C1_Queue_Complete(I2C1_OK);
+        }
+    }
+}
+
+void I2C1_ER_IRQHandler(void) {
+    u16 star1 = I2C1->STAR1;
+    u8 status = (star1 & I2C_STAR1_AF) ? I2C1_NACK : I2C1_BUS_ERROR;
+
+    I2C1->STAR1 = ~(I2C_STAR1_AF | I2C_STAR1_ARLO | I2C_STAR1_BERR | I2C_STAR1_OVR);
+
+    /* After lost arbitration we are no longer the master and must not send STOP */
+    if (!(star1 & I2C_STAR1_ARLO))
+        I2C_GenerateSTOP(I2C1, ENABLE);
+    I2C_AcknowledgeConfig(I2C1, ENABLE);
+    I2C1_Queue_Complete(status);
+}
@@ -5,7 +5,27 @@
 // 2023 by Stefan Wagner:   https://github.com/wagiminator
 
 #include "i2c_tx.h"
+#include "events.h"
 
+void I2C2_EV_IRQHandler(void) __attribute__((interrupt()));
+void I2C2_ER_IRQHandler(void) __attribute__((interrupt()));
+
+// Background transfers: bytes are copied into a ring pool and sent as a queue of
+// segments (one START/address/payload/STOP each), the payload going out by DMA.
+#define OLED_SEG_MASK (OLED_I2C_SEGMENTS - 1)
+
+typedef struct {
+  uint16_t off;                           // start of the payload in pool
+  uint16_t len;                           // payload length
+  uint8_t  addr;                          // 7 bit slave address
+} OLED_I2C_segment;
+
+static uint8_t pool[OLED_I2C_POOL];
+static OLED_I2C_segment segs[OLED_I2C_SEGMENTS];
+static volatile uint8_t seg_head;         // segment on the bus, advanced by the ISR
+static volatile uint8_t seg_tail;         // next free segment
+static volatile uint8_t dma_busy;
+static uint16_t pool_wr;                  // next free pool byte
 
 // Init I2C
 void OLED_I2C_init(void) {
@@ -38,10 +58,147 @@ void OLED_I2C_init(void) {
     I2C_AcknowledgeConfig(OLED_I2C_PORT, ENABLE);
 
     while( I2C_GetFlagStatus( OLED_I2C_PORT, I2C_FLAG_BUSY ) != RESET );
+
+    OLED_I2C_DMA_init();
+}
+
+// Init DMA1 channel 4 (I2C2_TX) and the I2C2 interrupts used for background transfers
+void OLED_I2C_DMA_init(void) {
+    DMA_InitTypeDef DMA_InitStructure = {0};
+    NVIC_InitTypeDef NVIC_InitStructure = {0};
+
+    OLED_I2C_wait();
+    seg_head = seg_tail = 0;
+    pool_wr = 0;
+
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+    DMA_DeInit(OLED_I2C_DMA);
+    DMA_StructInit(&DMA_InitStructure);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (u32)&OLED_I2C_PORT->DATAR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (u32)pool;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+    DMA_InitStructure.DMA_BufferSize = 0;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(OLED_I2C_DMA, &DMA_InitStructure);
+
+    NVIC_InitStructure.NVIC_IRQChannel = I2C2_EV_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    NVIC_InitStructure.NVIC_IRQChannel = I2C2_ER_IRQn;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
+// Start the segment at seg_head; events are only enabled while the queue runs,
+// so the blocking functions below never see this interrupt handler
+static void OLED_I2C_next(void) {
+  I2C_ITConfig(OLED_I2C_PORT, I2C_IT_EVT | I2C_IT_ERR, ENABLE);
+  I2C_GenerateSTART(OLED_I2C_PORT, ENABLE);
+}
+
+// Find len contiguous free bytes in the pool, or return -1 if it is still in use
+static int OLED_I2C_alloc(uint16_t len) {
+  if(seg_head == seg_tail) pool_wr = 0;           // idle, the whole pool is free
+  if((uint8_t)(seg_tail - seg_head) == OLED_I2C_SEGMENTS) return -1;
+  if(seg_head == seg_tail) return len <= OLED_I2C_POOL ? 0 : -1;
+
+  uint16_t oldest = segs[seg_head & OLED_SEG_MASK].off;
+  if(pool_wr >= oldest) {
+    if(OLED_I2C_POOL - pool_wr >= len) return pool_wr;
+    if(oldest > len) return 0;                    // wrap to the start of the pool
+  }
+  else if(oldest - pool_wr > len) return pool_wr;
+  return -1;
+}
+
+// Queue a write of len bytes to addr and return at once. Waits only if the pool is full.
+void OLED_I2C_send(uint8_t addr, const uint8_t *buf, uint16_t len) {
+  int off;
+  if(len == 0 || len > OLED_I2C_POOL) return;
+  while((off = OLED_I2C_alloc(len)) < 0);
+
+  for(uint16_t i = 0; i < len; i++) pool[off + i] = buf[i];
+  OLED_I2C_segment *seg = &segs[seg_tail & OLED_SEG_MASK];
+  seg->off = off;
+  seg->len = len;
+  seg->addr = addr;
+  pool_wr = off + len;
+
+  NVIC_DisableIRQ(I2C2_EV_IRQn);
+  NVIC_DisableIRQ(I2C2_ER_IRQn);
+  seg_tail++;
+  if(!dma_busy) {
+    dma_busy = 1;
+    OLED_I2C_next();
+  }
+  NVIC_EnableIRQ(I2C2_ER_IRQn);
+  NVIC_EnableIRQ(I2C2_EV_IRQn);
+}
+
+// True while queued display data is still being sent
+int OLED_I2C_busy(void) {
+  return dma_busy;
+}
+
+// Wait for all queued display data to be sent
+void OLED_I2C_wait(void) {
+  while(dma_busy);
+}
+
+static void OLED_I2C_done(void) {
+  seg_head++;
+  if(seg_head != seg_tail) OLED_I2C_next();
+  else {
+    I2C_ITConfig(OLED_I2C_PORT, I2C_IT_EVT | I2C_IT_ERR, DISABLE);
+    dma_busy = 0;
+    Event_Post(EVENT_DISPLAY_DONE);
+  }
+}
+
+void I2C2_EV_IRQHandler(void) {
+  OLED_I2C_segment *seg = &segs[seg_head & OLED_SEG_MASK];
+  uint16_t star1 = OLED_I2C_PORT->STAR1;
+
+  if(star1 & I2C_STAR1_SB) {
+    I2C_Send7bitAddress(OLED_I2C_PORT, seg->addr << 1, I2C_Direction_Transmitter);
+  }
+  else if(star1 & I2C_STAR1_ADDR) {
+    (void)OLED_I2C_PORT->STAR2;                   // clear ADDR, then hand TXE to the DMA
+    OLED_I2C_DMA->MADDR = (u32)&pool[seg->off];
+    OLED_I2C_DMA->CNTR = seg->len;
+    DMA_Cmd(OLED_I2C_DMA, ENABLE);
+    I2C_DMACmd(OLED_I2C_PORT, ENABLE);
+  }
+  else if((star1 & I2C_STAR1_BTF) && DMA_GetCurrDataCounter(OLED_I2C_DMA) == 0) {
+    I2C_DMACmd(OLED_I2C_PORT, DISABLE);           // last byte has left the shift register
+    DMA_Cmd(OLED_I2C_DMA, DISABLE);
+    I2C_GenerateSTOP(OLED_I2C_PORT, ENABLE);
+    OLED_I2C_done();
+  }
+}
+
+// NACK or bus error: drop the segment and carry on with the next one
+void I2C2_ER_IRQHandler(void) {
+  uint16_t star1 = OLED_I2C_PORT->STAR1;
+  OLED_I2C_PORT->STAR1 = ~(I2C_STAR1_AF | I2C_STAR1_ARLO | I2C_STAR1_BERR | I2C_STAR1_OVR);
+
+  I2C_DMACmd(OLED_I2C_PORT, DISABLE);
+  DMA_Cmd(OLED_I2C_DMA, DISABLE);
+  if(!(star1 & I2C_STAR1_ARLO)) I2C_GenerateSTOP(OLED_I2C_PORT, ENABLE);
+  OLED_I2C_done();
 }
 
 // Start I2C transmission (addr must contain R/W bit)
 void OLED_I2C_start(uint8_t addr) {
+	OLED_I2C_wait();
 	while( I2C_GetFlagStatus( OLED_I2C_PORT, I2C_FLAG_BUSY ) != RESET );
 	I2C_GenerateSTART(OLED_I2C_PORT, ENABLE);
 	while(!I2C_CheckEvent(OLED_I2C_PORT, I2C_EVENT_MASTER_MODE_SELECT));
@@ -0,0 +1,86 @@
+/*
+	Leaky DC blocker and blind Gram-Schmidt I/Q imbalance correction.
+*/
+#include <math.h>
+#include "iq_correct.h"
+
+/*
+	dc_shift sets the DC tracking time constant (2^dc_shift samples), adapt_shift
+	the number of blocks (2^adapt_shift) the imbalance estimate averages over.
+*/
+void iq_correct_init(iq_correct_t *c, uint8_t dc_shift, uint8_t adapt_shift) {
+	c->dc_i = 0;
+	c->dc_q = 0;
+	c->dc_shift = dc_shift;
+	c->ii = 0;
+	c->qq = 0;
+	c->iq = 0;
+	c->mu = 1.0f / (float)(1u << adapt_shift);
+	c->c_qi = 0;
+	c->c_qq = 1 << 14;
+}
+
+static inline int16_t saturate(int32_t x) {
+	if (x > 32767)
+		return 32767;
+	if (x < -32768)
+		return -32768;
+	return (int16_t)x;
+}
+
+static void iq_correct_update(iq_correct_t *c, int64_t ii, int64_t qq, int64_t iq, uint16_t n) {
+	float scale = 1.0f / n;
+	float q1;
+
+	c->ii += c->mu * ((float)ii * scale - c->ii);
+	c->qq += c->mu * ((float)qq * scale - c->qq);
+	c->iq += c->mu * ((float)iq * scale - c->iq);
+	if (c->ii <= 0)
+		return;
+
+	/* Power of Q once the part correlated with I is removed */
+	q1 = c->qq - c->iq * c->iq / c->ii;
+	if (q1 <= 0)
+		return;
+
+	float g = sqrtf(c->ii / q1);
+	float qi = -g * c->iq / c->ii;
+
+	/*
+		From +-2 on the estimate is nonsense (no signal), and 2.0 would not fit
+		Q14 in an int16; keep the last one
+	*/
+	if (g >= 2.0f || qi >= 2.0f || qi <= -2.0f)
+		return;
+	c->c_qq = (int16_t)(g * 16384.0f + 0.5f);
+	c->c_qi = (int16_t)(qi * 16384.0f + (qi < 0 ? -0.5f : 0.5f));
+}
+
+void iq_correct_process(iq_correct_t *c, int16_t *iq, uint16_t n) {
+	int32_t dc_i = c->dc_i, dc_q = c->dc_q;
+	int32_t c_qi = c->c_qi, c_qq = c->c_qq;
+	uint8_t shift = c->dc_shift;
+	int64_t ii = 0, qq = 0, iqs = 0;
+
+	for (uint16_t k = 0; k < n; k++) {
+		int32_t i = iq[2 * k] - (dc_i >> 16);
+		int32_t q = iq[2 * k + 1] - (dc_q >> 16);
+
+		/* A full-scale sample against the estimate spans 2^32: step the DC in 64 bits */
+		dc_i += (int32_t)(((int64_t)iq[2 * k] * 65536 - dc_i) >> shift);
+		dc_q += (int32_t)(((int64_t)iq[2 * k + 1] * 65536 - dc_q) >> shift);
+
+		/* i and q span +-65535 after the DC subtract: square them in 64 bits */
+		ii += (int64_t)i * i;
+		qq += (int64_t)q * q;
+		iqs += (int64_t)i * q;
+
+		iq[2 * k] = saturate(i);
+		iq[2 * k + 1] = saturate((int32_t)(((int64_t)c_qi * i + (int64_t)c_qq * q + (1 << 13)) >> 14));
+	}
+
+	c->dc_i = dc_i;
+	c->dc_q = dc_q;
+	if (n)
+		iq_correct_update(c, ii, qq, iqs, n);
+}
@@ -0,0 +1,104 @@
+#include <ch32v30x.h>
+#include "keys.h"
+#include "hardware.h"
+#include "events.h"
+#include "spsc_ring.h"
+
+typedef struct {
+    GPIO_TypeDef *port;         // 0: not fitted
+    u16 pin;
+    GPIOMode_TypeDef mode;
+} key_pin_t;
+
+static const key_pin_t KEY_PINS[KEY_COUNT] = {
+    [KEY_MODE] = { MODE_KEY_PORT, MODE_KEY_PIN, GPIO_Mode_IPD },
+    [KEY_PTT] = { PTT_KEY_PORT, PTT_KEY_PIN, GPIO_Mode_IPU },
+#ifdef LEFT_KEY_PIN
+    [KEY_LEFT] = { LEFT_KEY_PORT, LEFT_KEY_PIN, GPIO_Mode_IPU },
+#endif
+#ifdef RIGHT_KEY_PIN
+    [KEY_RIGHT] = { RIGHT_KEY_PORT, RIGHT_KEY_PIN, GPIO_Mode_IPU },
+#endif
+};
+
+static u8 integrator[KEY_COUNT];
+static u16 held[KEY_COUNT];     // ms since the debounced press
+static volatile u8 down;        // debounced state, bit per key
+
+static key_event_t queue[KEY_QUEUE_SIZE];
+static spsc_ring_t ring;        // Keys_Sample produces, Keys_Get consumes
+
+/*********************************************************************
+ * @fn      Keys_Init
+ *
+ * @brief   Configures the key inputs. Sampling is driven by the
+ *          Event_Init tick.
+ *
+ * @return  none
+ */
+void Keys_Init(void) {
+    GPIO_InitTypeDef GPIO_InitStructure = {0};
+
+    spsc_init(&ring, KEY_QUEUE_SIZE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA | RCC_APB2Periph_GPIOB | RCC_APB2Periph_GPIOC, ENABLE);
+    for (u8 k = 0; k < KEY_COUNT; k++) {
+        if (!KEY_PINS[k].port)
+            continue;
+        GPIO_InitStructure.GPIO_Pin = KEY_PINS[k].pin;
+        GPIO_InitStructure.GPIO_Mode = KEY_PINS[k].mode;
+        GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+        GPIO_Init(KEY_PINS[k].port, &GPIO_InitStructure);
+    }
+}
+
+static void Keys_Post(u8 key, u8 action) {
+    int32_t i = spsc_push_index(&ring);
+
+    if (i < 0)
+        return;                 // nobody is reading; drop
+    queue[i].key = key;
+    queue[i].action = action;
+    spsc_commit(&ring, 1);
+    Event_Post(EVENT_KEY);
+}
+
+/* 1 kHz, from the event tick */
+void Keys_Sample(void) {
+    for (u8 k = 0; k < KEY_COUNT; k++) {
+        u8 bit = 1 << k;
+
+        if (!KEY_PINS[k].port)
+            continue;
+
+        /* All keys are active low */
+        if (GPIO_ReadInputDataBit(KEY_PINS[k].port, KEY_PINS[k].pin) == Bit_RESET) {
+            if (integrator[k] < KEY_DEBOUNCE_MS && ++integrator[k] == KEY_DEBOUNCE_MS && !(down & bit)) {
+                down |= bit;
+                held[k] = 0;
+                Keys_Post(k, KEY_PRESS);
+            }
+        } else if (integrator[k] > 0 && --integrator[k] == 0 && (down & bit)) {
+            down &= ~bit;
+            Keys_Post(k, KEY_RELEASE);
+        }
+
+        if ((down & bit) && held[k] < KEY_LONG_MS && ++held[k] == KEY_LONG_MS)
+            Keys_Post(k, KEY_LONG_PRESS);
+    }
+}
+
+/* Next key event; 0 if there is none */
+int Keys_Get(key_event_t *event) {
+    int32_t i = spsc_pop_index(&ring);
+
+    if (i < 0)
+        return 0;
+    *event = queue[i];
+    spsc_release(&ring, 1);
+    return 1;
+}
+
+/* Debounced state of key */
+u8 Keys_Down(u8 key) {
+    return (down >> key) & 1;
+}
@@ -5,140 +5,256 @@
 #include "Si5351.h"
 #include "oled_min.h"
 #include "splash_screen.xbm"
+#include "dac_stream.h"
+#include "nco.h"
+#include "rx.h"
+#include "waterfall.h"
+#include "text_view.h"
+#include "events.h"
+#include "keys.h"
+#include "prof.h"
 void NMI_Handler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
 void HardFault_Handler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
-void EXTI9_5_IRQHandler(void)  __attribute__((interrupt(/*"WCH-Interrupt-fast"*/)));
 
 void Delay_Init(void);
 void Delay_Ms(uint32_t n);
 
 
-void KEY_Interrupt_Init(void) {
-
-    GPIO_InitTypeDef GPIO_InitStructure = {0};
-    EXTI_InitTypeDef EXTI_InitStructure = {0};
-    NVIC_InitTypeDef NVIC_InitStructure = {0};
-
-	/* PB9 'MODE' Key */
-    RCC_APB2PeriphClockCmd(RCC_APB2Periph_AFIO | RCC_APB2Periph_GPIOB, ENABLE);
-    GPIO_InitStructure.GPIO_Pin = MODE_KEY_PIN;
-    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IPD;
-    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
-    GPIO_Init(MODE_KEY_PORT, &GPIO_InitStructure);
-	
-	/* PC8 PTT Key */
-	RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOC, ENABLE);
-    GPIO_InitStructure.GPIO_Pin = PTT_KEY_PIN;
-    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IPU;
-    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
-    GPIO_Init(PTT_KEY_PORT, &GPIO_InitStructure);
-
-    GPIO_EXTILineConfig(GPIO_PortSourceGPIOB, GPIO_PinSource9);
-
-    EXTI_InitStructure.EXTI_Line = EXTI_Line9;
-    EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
-    EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Falling;
-    EXTI_InitStructure.EXTI_LineCmd = ENABLE;
-    EXTI_Init(&EXTI_InitStructure);
-
-    NVIC_InitStructure.NVIC_IRQChannel = EXTI9_5_IRQn;
-    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
-    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 2;
-    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
-    NVIC_Init(&NVIC_InitStructure);
-}
-
 #include "state.h"
 #include <u8g2.h>
+#include "display.h"
 
 extern u8g2_t u8g2;
 
 void u8g2_setup(void);
 
-volatile u8 current_state = STATE_IDLE;
-volatile u8 next_state = STATE_IDLE;
+u8 current_state = STATE_IDLE;
+
+/* Event timers */
+#define TIMER_BLINK 0
+#define TIMER_GAME  1
+
+/* MODE key order of the states */
+static const u8 NEXT_STATE[] = {
+	[STATE_IDLE] = STATE_SENDING,
+	[STATE_SENDING] = STATE_RECEIVING,
+	[STATE_RECEIVING] = STATE_SPECTRUM,
+	[STATE_SPECTRUM] = STATE_GAME,
+	[STATE_GAME] = STATE_IDLE,
+};
+
+static u8 display_pending;
+static u8 mode_long_press;
+
+static const char *const RX_LABELS[RX_MODE_COUNT] = {
+	[RX_MODE_USB] = "RX USB",
+	[RX_MODE_LSB] = "RX LSB",
+	[RX_MODE_CW] = "RX CW",
+	[RX_MODE_FM] = "RX FM",
+};
 
 /* Global define */
 #define N_SAMPLES 64
 
+/* TIM8 paces the DAC: 144 MHz / 24000 / 8 */
+#define DAC_SAMPLE_RATE 750
+/* Test tone with the period of the former 64 entry table: 750 Hz / 64 */
+#define TONE_FREQ_MHZ (DAC_SAMPLE_RATE * 1000 / N_SAMPLES)
+
 /* Global Variable */
-u16 DAC_Value[N_SAMPLES]={2048,2248,2447,2642,2831,3013,3185,3347,3496,3631,3750,3854,3940,4007,4056,4086,
-                         4095,4086,4056,4007,3940,3854,3750,3631,3496,3347,3185,3013,2831,2642,2447,2248,
-                         2048,1847,1648,1453,1264,1082,910 ,748 ,599 ,464 ,345 ,241 ,155 ,88  ,39  ,9   ,
-                         0   ,9   ,39  ,88  ,155 ,241 ,345 ,464 ,599 ,748 ,910 ,1082,1264,1453,1648,1847};
+u32 DAC_Buffer[2 * N_SAMPLES];
+nco_t tone;
+
+/* DMA half-transfer producer: next N_SAMPLES of the tone on I (cos) and Q (sin) */
+void Tone_Fill(u32 *samples, u16 count, void *context) {
+	int16_t iq[2 * N_SAMPLES];
+
+	nco_fill_iq((nco_t *)context, iq, count);
+	for (u16 k = 0; k < count; k++) {
+		samples[k] = DAC_IQ((iq[2 * k] >> 4) + 2048, (iq[2 * k + 1] >> 4) + 2048);
+	}
+}
+
+void Tone_Start(void) {
+	nco_init(&tone, TONE_FREQ_MHZ, DAC_SAMPLE_RATE, 1);
+	DAC_Stream_Start(DAC_Buffer, 2 * N_SAMPLES, Tone_Fill, &tone);
+	DAC_Timer_Init(0x7,24000-1);
+}
+
+/* States in which the receive chain owns the ADC and DAC */
+static int RX_State(u8 state) {
+	return state == STATE_RECEIVING || state == STATE_SPECTRUM;
+}
+
+/* Send the frame now, or as soon as the previous one has gone out */
+static void Display_Update(void) {
+	if (OLED_I2C_busy()) {
+		display_pending = 1;
+		return;
+	}
+	display_pending = 0;
+	PROF_BEGIN(PROF_DISPLAY_FLUSH);
+	Display_Flush(&u8g2);
+	PROF_END(PROF_DISPLAY_FLUSH);
+}
+
+static void Enter_State(u8 next_state) {
+	u8g2_ClearBuffer(&u8g2);
+	Display_Set_Start_Line(0);	// the waterfall leaves the panel scrolled
+	if (RX_State(current_state) && !RX_State(next_state)) {
+		/* Give the DAC back to the test tone */
+		RX_Stop();
+		Tone_Start();
+		AudioEnable();
+	}
+	Event_Timer_Stop(TIMER_BLINK);
+	Event_Timer_Stop(TIMER_GAME);
+
+	switch (next_state) {
+		case STATE_IDLE:
+			u8g2_DrawStr(&u8g2,2,30,"IDLE");
+			Event_Timer_Start(TIMER_BLINK, 1000);
+			break;
+		case STATE_SENDING:
+			u8g2_DrawStr(&u8g2,2,30,"TX");
+			Event_Timer_Start(TIMER_BLINK, 100);
+			break;
+		case STATE_RECEIVING:
+			u8g2_DrawStr(&u8g2,2,30,RX_LABELS[RX_Mode()]);
+			Text_View_Clear();
+			if (!RX_State(current_state))
+				RX_Start();
+			break;
+		case STATE_SPECTRUM:
+			if (!RX_State(current_state))
+				RX_Start();
+			Waterfall_Init(&u8g2);
+			RX_Spectrum_Request();
+			break;
+		case STATE_GAME:
+			u8g2_DrawStr(&u8g2,2,30,"GAME");
+
+			tiny_invaders_setup();
+			Event_Timer_Start(TIMER_GAME, 2);
+			break;
+	}
+	Display_Update();
+	current_state = next_state;
+}
+
+/*
+ * MODE: a short press (acted on at release) moves to the next state, a long
+ * press cycles the receive mode. PTT is read by the game through Keys_Down;
+ * outside the game a long PTT press dumps the profiling table.
+ */
+static void Key_Event(const key_event_t *event) {
+	if (event->key == KEY_PTT && event->action == KEY_LONG_PRESS && current_state != STATE_GAME) {
+		Prof_Dump();
+		return;
+	}
+	if (event->key != KEY_MODE)
+		return;
+
+	switch (event->action) {
+		case KEY_PRESS:
+			mode_long_press = 0;
+			break;
+		case KEY_LONG_PRESS:
+			mode_long_press = 1;
+			if (RX_State(current_state)) {
+				RX_Set_Mode((RX_Mode() + 1) % RX_MODE_COUNT);
+				if (current_state == STATE_RECEIVING) {
+					u8g2_SetDrawColor(&u8g2, 0);
+					u8g2_DrawBox(&u8g2, 0, 0, 128, TEXT_VIEW_TOP);
+					u8g2_SetDrawColor(&u8g2, 1);
+					u8g2_DrawStr(&u8g2,2,30,RX_LABELS[RX_Mode()]);
+					Display_Update();
+				}
+			}
+			break;
+		case KEY_RELEASE:
+			if (!mode_long_press)
+				Enter_State(NEXT_STATE[current_state]);
+			break;
+	}
+}
 
 int main(void)
 {
 	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_2);
 	SystemCoreClockUpdate();
 	Delay_Init();
+	Prof_Init();
 
 	Delay_Ms(1000);
 
 	GPIO_Pins_Init();
-	DAC_Initialize();
+	DAC_Dual_Initialize();
 
 	AudioEnable();
 
-	DAC_DMA_Init(&DAC_Value[0], N_SAMPLES);
-	DAC_Timer_Init(0x7,24000-1);
+	Tone_Start();
 
     RCC_AHBPeriphClockCmd(RCC_AHBPeriph_RNG, ENABLE);
 	RNG_Cmd(ENABLE);
 
 	Synthesizer_Init(100000, 0x77);
 
-    KEY_Interrupt_Init();
+    Keys_Init();
 
 	OLED_I2C_init();
 
 	u8g2_setup();
 
 	u8g2_DrawXBM(&u8g2, 0, 0, 128, 64, splash_screen_bits);
- 	u8g2_SendBuffer(&u8g2);
+ 	Display_Flush(&u8g2);
+
+	/* The splash screen stays up in STATE_IDLE until the first MODE press */
+	Event_Init();
+	Event_Timer_Start(TIMER_BLINK, 1000);
 
-	uint8_t ledState = 0;
 	while (1)
 	{
-		if (current_state != next_state) {
-			u8g2_ClearBuffer(&u8g2);
-			switch (next_state) {
-				case STATE_IDLE:
-					u8g2_DrawStr(&u8g2,2,30,"IDLE");
-					break;
-				case STATE_SENDING:
-					u8g2_DrawStr(&u8g2,2,30,"TX");
-					break;
-				case STATE_RECEIVING:
-					u8g2_DrawStr(&u8g2,2,30,"RX");
-					break;
-				case STATE_GAME:
-					u8g2_DrawStr(&u8g2,2,30,"GAME");
-
-					tiny_invaders_setup();
-					break;
-			}
- 			u8g2_SendBuffer(&u8g2);
-			current_state = next_state;
+		u32 events = Event_Wait();
+
+		if (events & EVENT_BIT(EVENT_KEY)) {
+			key_event_t event;
+			while (Keys_Get(&event))
+				Key_Event(&event);
 		}
-		switch (current_state) {
-			case STATE_IDLE:
-				GPIO_WriteBit(BLINKY_GPIO_PORT, BLINKY_GPIO_PIN, ledState);
-				ledState ^= 1; // invert for the next run
-				Delay_Ms(1000);
-				break;
-			case STATE_SENDING:
-				GPIO_WriteBit(BLINKY_GPIO_PORT, BLINKY_GPIO_PIN, ledState);
-				ledState ^= 1; // invert for the next run
-				Delay_Ms(100);
-				break;
-			case STATE_RECEIVING:
-				break;
-			case STATE_GAME:
-				tiny_invaders_loop();
-				Delay_Ms(2);
-				break;
+
+		if (events & EVENT_BIT(EVENT_TIMER_0 + TIMER_BLINK))
+			GPIO_WriteBit(BLINKY_GPIO_PORT, BLINKY_GPIO_PIN,
+			              !GPIO_ReadOutputDataBit(BLINKY_GPIO_PORT, BLINKY_GPIO_PIN));
+
+		if ((events & EVENT_BIT(EVENT_TIMER_0 + TIMER_GAME)) && current_state == STATE_GAME) {
+			PROF_BEGIN(PROF_GAME_LOOP);
+			tiny_invaders_loop();
+			PROF_END(PROF_GAME_LOOP);
 		}
+
+		/* Decoded CW scrolls along the bottom of the screen */
+		if ((events & EVENT_BIT(EVENT_CW_TEXT)) && current_state == STATE_RECEIVING) {
+			char c;
+			while ((c = RX_CW_Getc()))
+				Text_View_Putc(c);
+			Text_View_Draw(&u8g2);
+			Display_Update();
+		}
+
+		if ((events & EVENT_BIT(EVENT_SPECTRUM)) && current_state == STATE_SPECTRUM) {
+			int16_t *block = RX_Spectrum_Block();
+			if (block) {
+				PROF_BEGIN(PROF_WATERFALL);
+				Waterfall_Update(&u8g2, block);
+				PROF_END(PROF_WATERFALL);
+				Display_Update();
+				RX_Spectrum_Request();
+			}
+		}
+
+		if ((events & EVENT_BIT(EVENT_DISPLAY_DONE)) && display_pending)
+			Display_Update();
 	}
 }
 
@@ -149,34 +265,3 @@ void HardFault_Handler(void)
 	{
 	}
 }
-
-
-
-/*********************************************************************
- * @fn      EXTI9_IRQHandler
- *
- * @brief   This function handles EXTI0 Handler.
- *
- * @return  none
- */
-void EXTI9_5_IRQHandler(void)
-{
-  	if(EXTI_GetITStatus(EXTI_Line9) != RESET)
-    {
-		switch (current_state) {
-			case STATE_IDLE:
-				next_state = STATE_SENDING;
-				break;
-			case STATE_SENDING:
-				next_state = STATE_RECEIVING;
-				break;
-			case STATE_RECEIVING:
-				next_state = STATE_GAME;
-				break;
-			case STATE_GAME:
-				next_state = STATE_IDLE;
-				break;
-		}
-        EXTI_ClearITPendingBit(EXTI_Line9); /* Clear Flag */
-    }
-}
\ No newline at end of file
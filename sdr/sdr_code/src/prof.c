@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <debug.h>
+#include "prof.h"
+
+#ifdef PROFILE
+
+typedef struct {
+    u32 count;
+    u32 min;
+    u32 max;
+    uint64_t total;
+    u32 histogram[PROF_BUCKETS];
+} prof_entry_t;
+
+static const char *const PROF_NAMES[PROF_COUNT] = {
+    [PROF_RX_PROCESS] = "rx_process",
+    [PROF_AUDIO_FILL] = "audio_fill",
+    [PROF_DISPLAY_FLUSH] = "display_flush",
+    [PROF_SEND_BUFFER] = "send_buffer",
+    [PROF_WATERFALL] = "waterfall",
+    [PROF_GAME_LOOP] = "game_loop",
+    [PROF_UPDATE_DISPLAY] = "update_display",
+    [PROF_SI5351_SET_FREQUENCY] = "si5351_set_freq",
+};
+
+static prof_entry_t table[PROF_COUNT];
+
+/*********************************************************************
+ * @fn      Prof_Init
+ *
+ * @brief   Opens the debug UART for Prof_Dump and clears the table.
+ *
+ * @return  none
+ */
+void Prof_Init(void) {
+    USART_Printf_Init(PROF_BAUD);
+    Prof_Reset();
+}
+
+void Prof_Reset(void) {
+    for (u8 id = 0; id < PROF_COUNT; id++) {
+        table[id] = (prof_entry_t){0};
+        table[id].min = 0xFFFFFFFF;
+    }
+}
+
+void Prof_Record(u8 id, u32 cycles) {
+    prof_entry_t *e = &table[id];
+    u8 bucket = cycles ? 31 - __builtin_clz(cycles) : 0;
+
+    if (bucket >= PROF_BUCKETS)
+        bucket = PROF_BUCKETS - 1;
+    e->count++;
+    e->total += cycles;
+    if (cycles < e->min)
+        e->min = cycles;
+    if (cycles > e->max)
+        e->max = cycles;
+    e->histogram[bucket]++;
+}
+
+/*********************************************************************
+ * @fn      Prof_Dump
+ *
+ * @brief   Prints count, min/mean/max in cycles and the non-empty
+ *          histogram buckets ("k:n" = n runs of 2^k.. cycles) of
+ *          every probe that has run.
+ *
+ * @return  none
+ */
+void Prof_Dump(void) {
+    printf("\r\nprobe            count      min     mean      max  (cycles @ %lu Hz)\r\n",
+           (unsigned long)SystemCoreClock);
+    for (u8 id = 0; id < PROF_COUNT; id++) {
+        const prof_entry_t *e = &table[id];
+
+        if (!e->count)
+            continue;
+        printf("%-15s %6lu %8lu %8lu %8lu\r\n  ", PROF_NAMES[id], (unsigned long)e->count,
+               (unsigned long)e->min, (unsigned long)(e->total / e->count), (unsigned long)e->max);
+        for (u8 b = 0; b < PROF_BUCKETS; b++) {
+            if (e->histogram[b])
+                printf(" %u:%lu", b, (unsigned long)e->histogram[b]);
+        }
+        printf("\r\n");
+    }
+}
+
+#endif
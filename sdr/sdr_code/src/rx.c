@@ -0,0 +1,134 @@
+#include <ch32v30x.h>
+#include <string.h>
+#include "rx.h"
+#include "adc_iq.h"
+#include "audio_out.h"
+#include "decimate.h"
+#include "iq_correct.h"
+#include "fm_demod.h"
+#include "weaver.h"
+#include "cw_decoder.h"
+#include "agc.h"
+#include "events.h"
+#include "prof.h"
+
+static u32 RX_Buffer[2 * RX_ADC_HALF];
+
+static decimator_t decimator;
+static iq_correct_t correct;
+static fm_demod_t fm;
+static weaver_t weaver;
+static cw_decoder_t cw;
+static agc_t agc;
+static u8 mode = RX_MODE_USB;
+
+static int16_t spectrum_block[2 * RX_SPECTRUM_N];
+static u16 spectrum_fill;
+static volatile u8 spectrum_state;      // 0 idle, 1 collecting, 2 ready
+
+/* Copy corrected baseband for the display while it asks for it */
+static void RX_Spectrum_Collect(const int16_t *iq, u16 n) {
+    if (spectrum_state != 1)
+        return;
+    if (n > RX_SPECTRUM_N - spectrum_fill)
+        n = RX_SPECTRUM_N - spectrum_fill;
+    memcpy(&spectrum_block[2 * spectrum_fill], iq, n * 2 * sizeof(int16_t));
+    spectrum_fill += n;
+    if (spectrum_fill == RX_SPECTRUM_N) {
+        spectrum_state = 2;
+        Event_Post(EVENT_SPECTRUM);
+    }
+}
+
+/* One ADC half, processed in place: each packed word becomes one I/Q pair */
+static void RX_Process(u32 *samples, u16 count, void *context) {
+    int16_t *iq = (int16_t *)samples;
+    int16_t audio[RX_BLOCK];
+    u16 n;
+    PROF_BEGIN(PROF_RX_PROCESS);
+
+    ADC_IQ_Unpack(samples, iq, count);
+    n = decimator_process(&decimator, iq, count);
+    iq_correct_process(&correct, iq, n);
+    RX_Spectrum_Collect(iq, n);
+    if (mode == RX_MODE_FM)
+        fm_demod_process(&fm, iq, audio, n);
+    else
+        weaver_process(&weaver, iq, audio, n);
+    if (mode == RX_MODE_CW) {
+        cw_decoder_process(&cw, audio, n);
+        if (spsc_count(&cw.text_ring))
+            Event_Post(EVENT_CW_TEXT);
+    }
+    agc_process(&agc, audio, n);
+    Audio_Write(audio, n);
+    PROF_END(PROF_RX_PROCESS);
+}
+
+static void RX_Demod_Init(void) {
+    switch (mode) {
+        case RX_MODE_USB:
+            weaver_init(&weaver, RX_AUDIO_RATE, WEAVER_USB_CENTRE_MHZ, WEAVER_SSB_TAPS);
+            break;
+        case RX_MODE_LSB:
+            weaver_init(&weaver, RX_AUDIO_RATE, -WEAVER_USB_CENTRE_MHZ, WEAVER_SSB_TAPS);
+            break;
+        case RX_MODE_CW:
+            weaver_init(&weaver, RX_AUDIO_RATE, WEAVER_CW_PITCH_MHZ, WEAVER_CW_TAPS);
+            cw_decoder_init(&cw, RX_AUDIO_RATE, WEAVER_CW_PITCH_MHZ / 1000);
+            break;
+        case RX_MODE_FM:
+            fm_demod_init(&fm, RX_AUDIO_RATE, RX_FM_DEVIATION, RX_FM_DEEMPH_US);
+            break;
+    }
+}
+
+/*********************************************************************
+ * @fn      RX_Start
+ *
+ * @brief   Starts capture, demodulation and audio output. The DAC is
+ *          taken over for audio until RX_Stop.
+ *
+ * @return  none
+ */
+void RX_Start(void) {
+    decimator_init_default(&decimator);
+    iq_correct_init(&correct, RX_IQ_DC_SHIFT, RX_IQ_ADAPT_SHIFT);
+    RX_Demod_Init();
+    agc_init(&agc, RX_AUDIO_RATE, RX_BLOCK, 16000, 40, 2, 20, 300);
+
+    /* The ADC timer can only approximate RX_ADC_RATE; resample from the real rate */
+    u32 adc_rate = ADC_IQ_Start(RX_ADC_RATE, RX_Buffer, 2 * RX_ADC_HALF, RX_Process, 0);
+    Audio_Start(adc_rate / decimator_ratio(&decimator));
+}
+
+void RX_Stop(void) {
+    ADC_IQ_Stop();
+    Audio_Stop();
+    spectrum_state = 0;
+}
+
+/* Switch demodulator; safe while running */
+void RX_Set_Mode(u8 new_mode) {
+    NVIC_DisableIRQ(DMA1_Channel1_IRQn);
+    mode = new_mode;
+    RX_Demod_Init();
+    NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+}
+
+u8 RX_Mode(void) {
+    return mode;
+}
+
+char RX_CW_Getc(void) {
+    return mode == RX_MODE_CW ? cw_decoder_getc(&cw) : 0;
+}
+
+void RX_Spectrum_Request(void) {
+    spectrum_fill = 0;
+    spectrum_state = 1;
+}
+
+int16_t *RX_Spectrum_Block(void) {
+    return spectrum_state == 2 ? spectrum_block : 0;
+}
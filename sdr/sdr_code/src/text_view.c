@@ -0,0 +1,48 @@
+// ===================================================================================
+// Scrolling text lines at the bottom of the display
+// ===================================================================================
+
+#include <string.h>
+#include "text_view.h"
+
+#define LINE_HEIGHT 10
+
+static char lines[TEXT_VIEW_LINES][TEXT_VIEW_COLS + 1];
+static uint8_t column;
+
+void Text_View_Clear(void) {
+  memset(lines, 0, sizeof(lines));
+  column = 0;
+}
+
+static void Text_View_Scroll(void) {
+  memmove(lines[0], lines[1], (TEXT_VIEW_LINES - 1) * sizeof(lines[0]));
+  memset(lines[TEXT_VIEW_LINES - 1], 0, sizeof(lines[0]));
+  column = 0;
+}
+
+void Text_View_Putc(char c) {
+  char *line = lines[TEXT_VIEW_LINES - 1];
+
+  if(c == '\n') {
+    Text_View_Scroll();
+    return;
+  }
+  if(column == TEXT_VIEW_COLS) {
+    Text_View_Scroll();
+    if(c == ' ')
+      return;                     // no leading space on a wrapped line
+  }
+  line[column++] = c;
+}
+
+void Text_View_Draw(u8g2_t *u8g2) {
+  u8g2_SetDrawColor(u8g2, 0);
+  u8g2_DrawBox(u8g2, 0, TEXT_VIEW_TOP, 128, 64 - TEXT_VIEW_TOP);
+  u8g2_SetDrawColor(u8g2, 1);
+
+  u8g2_SetFont(u8g2, u8g2_font_6x10_tr);
+  for(uint8_t i = 0; i < TEXT_VIEW_LINES; i++)
+    u8g2_DrawStr(u8g2, 0, TEXT_VIEW_TOP + (i + 1) * LINE_HEIGHT - 2, lines[i]);
+  u8g2_SetFont(u8g2, u8g2_font_fub14_tf);   // the default set in u8g2_setup()
+}
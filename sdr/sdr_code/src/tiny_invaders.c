@@ -25,6 +25,9 @@
 #include <ch32v30x.h>
 #include <ch32v30x_rng.h>
 #include "hardware.h"
+#include "display.h"
+#include "keys.h"
+#include "prof.h"
 
 //#include <toneAC2.h>
  
@@ -335,7 +338,7 @@ int setHighScore(int Hs) {
 
 bool fireButtonPressed(void) {
   // Return true if fire button is pressed
-  return PTT_Pressed();
+  return Keys_Down(KEY_PTT);
 }
 
 bool fire2ButtonPressed(void) {
@@ -344,13 +347,13 @@ bool fire2ButtonPressed(void) {
 }
 
 bool leftButtonPressed(void) {
-  // Return true if left button is pressed
-  return false; // !digitalRead(X_pin);
+  // Return true if left button is pressed (only when one is fitted)
+  return Keys_Down(KEY_LEFT);
 }
 
 bool rightButtonPressed(void) {
-  // Return true if right button is pressed
-  return false; // !digitalRead(Y_pin);
+  // Return true if right button is pressed (only when one is fitted)
+  return Keys_Down(KEY_RIGHT);
 }
 
 bool downButtonPressed(void) {
@@ -408,6 +411,7 @@ void tiny_invaders_setup(){
   //OLED Diplay
   /* U8g2 Project: SSD1306 or SH1106 OLED SPI Board */
   u8g2_ClearDisplay(&u8g2);
+  Display_Invalidate();                         // display was cleared behind Display_Flush's back
   u8g2_SetBitmapMode(&u8g2,1);
   //display.begin(SSD1306_SWITCHCAPVCC,OLED_ADDRESS);
   InitAliens(0); 
@@ -435,7 +439,9 @@ void tiny_invaders_loop(){
   if(GameInPlay)
   {
     Physics();
+    PROF_BEGIN(PROF_UPDATE_DISPLAY);
     UpdateDisplay();
+    PROF_END(PROF_UPDATE_DISPLAY);
   }
   else  
     AttractScreen();
@@ -481,7 +487,7 @@ void AttractScreen(void){
   sprintf(str, "Hi Score %d", HiScore);
   u8g2_DrawStr(&u8g2, ColPosition, RowHeight, str);
 
-  u8g2_SendBuffer(&u8g2);
+  Display_Flush(&u8g2);
 
   if((fireButtonPressed())|(fire2ButtonPressed())){
     GameInPlay=true;
@@ -1318,7 +1324,7 @@ void UpdateDisplay(){
       u8g2_DrawXBM(&u8g2,Base[i].Ord.X, Base[i].Ord.Y, BASE_WIDTH, BASE_HEIGHT, Base[i].Gfx);
   }
   //display.display();
-  u8g2_SendBuffer(&u8g2);
+  Display_Flush(&u8g2);
 }
 
 void LoseLife(void){
@@ -1367,7 +1373,7 @@ void GameOver(){
     CenterText("**CONGRATULATIONS**",RowHeight);    
   }
   //display.display();
-  u8g2_SendBuffer(&u8g2);
+  Display_Flush(&u8g2);
   if(Player.Score>HiScore){    
     setHighScore(Player.Score);
     PlayRewardMusic();
@@ -1405,7 +1411,7 @@ void DisplayPlayerAndLives(PlayerStruct *Player){
   CenterText("Level ",RowHeight);   
   printNum(Player->Level, SCREEN_WIDTH*3/2, RowHeight);
   //display.display();
-  u8g2_SendBuffer(&u8g2);
+  Display_Flush(&u8g2);
   Delay_Ms(2000);
   Player->Ord.X=PLAYER_X_START;
 }
@@ -47,8 +47,6 @@ uint8_t u8g2_gpio_and_delay_stm32(U8X8_UNUSED u8x8_t *u8x8, U8X8_UNUSED uint8_t
   return 1;
 }
 
-void I2C_Master_Transmit(uint8_t *buff, uint8_t idx );
-
  
 
 
@@ -80,7 +78,8 @@ uint8_t u8x8_byte_wch32_hw_i2c(u8x8_t *u8g2, uint8_t msg, uint8_t arg_int, void
 			buf_idx = 0;
 			break;
 		case U8X8_MSG_BYTE_END_TRANSFER:
-			I2C_Master_Transmit((uint8_t *)buffer, buf_idx);
+			// queued and sent by DMA, u8g2_SendBuffer returns before the display is updated
+			OLED_I2C_send(OLED_ADDR, buffer, buf_idx);
 			break;
 		default:
 			return 0;
@@ -114,21 +113,3 @@ void u8g2_setup(void)
 
  u8g2_SendBuffer(&u8g2);
 }
-
-
-
-
-void I2C_Master_Transmit(uint8_t *buff, uint8_t idx )
-{
- u8 i = 0;
-
-  OLED_I2C_start(OLED_ADDR);
-
-  while(idx > 0)
-  {
-     OLED_I2C_write(buff[i]);
-     idx--;
-     i++;
-  }
-  OLED_I2C_stop();
-}
\ No newline at end of file
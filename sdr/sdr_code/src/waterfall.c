@@ -0,0 +1,95 @@
+// ===================================================================================
+// Spectrum and waterfall view of the receiver baseband
+// ===================================================================================
+//
+// Each frame: Hann window, 256 point FFT, two bins per column, log2 power averaged
+// per column. Levels are taken relative to a tracked noise floor and quantised to
+// 16 steps: bar height in the spectrum, 4x4 ordered dither in the waterfall.
+//
+// The frame buffer is the panel RAM, used as a ring of 64 rows. The display start
+// line names the RAM row shown at the top; moving it up one row scrolls the whole
+// picture down, so each frame rewrites only the 16 spectrum rows and the new
+// waterfall row below them: 17 rows, 3 pages, however the ring is aligned.
+
+#include <stdint.h>
+#include <string.h>
+#include "waterfall.h"
+#include "display.h"
+#include "fft.h"
+#include "agc.h"
+
+#define WIDTH        128
+#define SPECTRUM_ROWS 16
+#define LINES         64
+#define LEVELS        16
+
+// WATERFALL_RANGE_DB of power in Q8 log2 units (256 = 3.01 dB)
+#define RANGE_LOG (WATERFALL_RANGE_DB * 256 * 100 / 301)
+
+static const uint8_t BAYER[4][4] = {
+  {  0,  8,  2, 10 },
+  { 12,  4, 14,  6 },
+  {  3, 11,  1,  9 },
+  { 15,  7, 13,  5 },
+};
+
+static int32_t average[WIDTH];   // log2 power per column, Q8
+static int32_t floor_log;
+static uint8_t row_count;
+static uint8_t top;              // RAM row at the top of the screen
+
+void Waterfall_Init(u8g2_t *u8g2) {
+  memset(average, 0, sizeof(average));
+  floor_log = 0;
+  row_count = 0;
+  top = 0;
+  u8g2_ClearBuffer(u8g2);
+  Display_Set_Start_Line(top);
+}
+
+static inline void put_pixel(uint8_t *buf, uint8_t line, uint8_t x, uint8_t on) {
+  uint8_t *b = &buf[(line >> 3) * WIDTH + x];
+  uint8_t mask = 1 << (line & 7);
+
+  *b = on ? *b | mask : *b & ~mask;
+}
+
+void Waterfall_Update(u8g2_t *u8g2, int16_t *iq) {
+  uint8_t *buf = u8g2_GetBufferPtr(u8g2);
+  int32_t lowest = INT32_MAX;
+
+  fft_window_hann(iq, WATERFALL_FFT_N);
+  fft_q15(iq, WATERFALL_FFT_N);
+
+  // Column 0 is -fs/2, column 64 is DC
+  for(uint8_t x = 0; x < WIDTH; x++) {
+    uint16_t bin = (2 * x + WATERFALL_FFT_N / 2) & (WATERFALL_FFT_N - 1);
+    int32_t r0 = iq[2 * bin], i0 = iq[2 * bin + 1];
+    int32_t r1 = iq[2 * bin + 2], i1 = iq[2 * bin + 3];
+    uint32_t power = (uint32_t)(r0 * r0 + i0 * i0) + (uint32_t)(r1 * r1 + i1 * i1);
+
+    average[x] += (agc_log2_q8(power + 1) - average[x]) >> 2;
+    if(average[x] < lowest)
+      lowest = average[x];
+  }
+  floor_log += (lowest - floor_log) >> 3;
+
+  // Scroll down one row: the oldest waterfall row wraps round to the top and the
+  // last spectrum row becomes the newest waterfall row
+  top = (top - 1) & (LINES - 1);
+
+  for(uint8_t x = 0; x < WIDTH; x++) {
+    int32_t level = (average[x] - floor_log) * LEVELS / RANGE_LOG;
+    if(level < 0) level = 0;
+    if(level > LEVELS - 1) level = LEVELS - 1;
+
+    // Bar of level + 1 pixels standing on screen row SPECTRUM_ROWS - 1
+    for(uint8_t y = 0; y < SPECTRUM_ROWS; y++)
+      put_pixel(buf, (top + y) & (LINES - 1), x, y >= SPECTRUM_ROWS - 1 - level);
+
+    // New top waterfall row
+    put_pixel(buf, (top + SPECTRUM_ROWS) & (LINES - 1), x, level > BAYER[row_count & 3][x & 3]);
+  }
+  row_count++;
+  Display_Set_Start_Line(top);
+}
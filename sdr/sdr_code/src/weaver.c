@@ -0,0 +1,44 @@
+/*
+	Weaver (third method) SSB/CW demodulation on interleaved Q15 I/Q.
+*/
+#include "weaver.h"
+
+void weaver_init(weaver_t *w, uint32_t sample_rate, int32_t centre_mhz, const int16_t *taps) {
+	nco_init(&w->nco, centre_mhz, sample_rate, 0);
+	fir_init(&w->lpf, taps, WEAVER_TAPS, 1);
+}
+
+/* iq is used as scratch; audio receives n samples */
+void weaver_process(weaver_t *w, int16_t *iq, int16_t *audio, uint16_t n) {
+	int16_t osc[2 * WEAVER_MAX_BLOCK];
+
+	while (n) {
+		uint16_t len = n > WEAVER_MAX_BLOCK ? WEAVER_MAX_BLOCK : n;
+
+		nco_fill_iq(&w->nco, osc, len);
+
+		/* Down: (I + jQ)(c - js) */
+		for (uint16_t k = 0; k < len; k++) {
+			int32_t i = iq[2 * k], q = iq[2 * k + 1];
+			int32_t c = osc[2 * k], s = osc[2 * k + 1];
+
+			iq[2 * k] = (int16_t)((i * c + q * s + 0x4000) >> 15);
+			iq[2 * k + 1] = (int16_t)((q * c - i * s + 0x4000) >> 15);
+		}
+
+		fir_process(&w->lpf, iq, len);
+
+		/* Up: Re{(I + jQ)(c + js)} */
+		for (uint16_t k = 0; k < len; k++) {
+			int32_t i = iq[2 * k], q = iq[2 * k + 1];
+			int32_t c = osc[2 * k], s = osc[2 * k + 1];
+			int32_t y = (i * c - q * s + 0x4000) >> 15;
+
+			audio[k] = y > 32767 ? 32767 : y < -32768 ? -32768 : (int16_t)y;
+		}
+
+		iq += 2 * len;
+		audio += len;
+		n -= len;
+	}
+}
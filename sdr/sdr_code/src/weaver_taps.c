@@ -0,0 +1,32 @@
+/*
+	Q15 Weaver low-pass filters, 63 taps at 12000 Hz.
+
+	Generated by scripts/gen_weaver_taps.py - do not edit by hand.
+*/
+
+#include "weaver.h"
+
+/* Cutoff 1200 Hz */
+const int16_t WEAVER_SSB_TAPS[63] = {
+	     5,      0,    -11,    -25,    -33,    -27,      0,     43,
+	    87,    107,     80,      0,   -115,   -221,   -261,   -189,
+	     0,    257,    484,    562,    404,      0,   -551,  -1049,
+	 -1247,   -931,      0,   1471,   3232,   4912,   6119,   6562,
+	  6119,   4912,   3232,   1471,      0,   -931,  -1247,  -1049,
+	  -551,      0,    404,    562,    484,    257,      0,   -189,
+	  -261,   -221,   -115,      0,     80,    107,     87,     43,
+	     0,    -27,    -33,    -25,    -11,      0,      5,
+};
+
+/* Cutoff 250 Hz */
+const int16_t WEAVER_CW_TAPS[63] = {
+	    -7,    -10,    -12,    -14,    -14,    -13,     -8,      0,
+	    13,     31,     56,     88,    128,    176,    233,    298,
+	   372,    453,    540,    633,    729,    828,    926,   1022,
+	  1114,   1198,   1274,   1340,   1392,   1431,   1454,   1466,
+	  1454,   1431,   1392,   1340,   1274,   1198,   1114,   1022,
+	   926,    828,    729,    633,    540,    453,    372,    298,
+	   233,    176,    128,     88,     56,     31,     13,      0,
+	    -8,    -13,    -14,    -14,    -12,    -10,     -7,
+};
+
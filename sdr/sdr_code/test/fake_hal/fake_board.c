@@ -0,0 +1,63 @@
+#include "fake_hal.h"
+#include "hardware.h"
+#include "events.h"
+#include "keys.h"
+
+static u8 amplifier_on;
+static u32 events;
+static u8 keys_down;
+
+void Fake_Board_Reset(void) {
+    amplifier_on = 0;
+    events = 0;
+    keys_down = 0;
+}
+
+/* ---- hardware.c ---- */
+
+void AudioEnable(void) {
+    amplifier_on = 1;
+}
+
+void AudioShutdown(void) {
+    amplifier_on = 0;
+}
+
+u8 Fake_Amplifier_On(void) {
+    return amplifier_on;
+}
+
+/* ---- events.c: posts are collected, time is the simulated clock ---- */
+
+void Event_Post(u8 event) {
+    events |= EVENT_BIT(event);
+}
+
+u32 Fake_Events_Take(void) {
+    u32 taken = events;
+
+    events = 0;
+    return taken;
+}
+
+u32 Event_Millis(void) {
+    return (u32)(Fake_Clock_Cycles() / (SystemCoreClock / 1000));
+}
+
+/* ---- keys.c: state set by the test, no debounced events ---- */
+
+void Fake_Key_Set(u8 key, u8 down) {
+    if (down)
+        keys_down |= 1 << key;
+    else
+        keys_down &= ~(1 << key);
+}
+
+u8 Keys_Down(u8 key) {
+    return (keys_down >> key) & 1;
+}
+
+int Keys_Get(key_event_t *event) {
+    (void)event;
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "fake_hal.h"
+#include "debug.h"
+
+u32 SystemCoreClock = 144000000;
+
+static uint64_t cycles;
+static u32 rng_state;
+
+/* Reset and clock hooks of the other fakes */
+void Fake_I2C_Reset(void);
+void Fake_DMA_Reset(void);
+void Fake_DMA_Clock(uint64_t now);
+void Fake_Board_Reset(void);
+
+/*********************************************************************
+ * @fn      Fake_HAL_Reset
+ *
+ * @brief   Back to cycle 0 with stopped streams, empty logs and all
+ *          keys up.
+ *
+ * @return  none
+ */
+void Fake_HAL_Reset(void) {
+    SystemCoreClock = 144000000;
+    cycles = 0;
+    rng_state = 0x2545F491;
+    Fake_I2C_Reset();
+    Fake_DMA_Reset();
+    Fake_Board_Reset();
+}
+
+uint64_t Fake_Clock_Cycles(void) {
+    return cycles;
+}
+
+/* Moves time on; DAC halves that come due meanwhile are played in order */
+void Fake_Clock_Advance(uint64_t n) {
+    cycles += n;
+    Fake_DMA_Clock(cycles);
+}
+
+void Fake_Clock_Advance_Us(uint32_t us) {
+    Fake_Clock_Advance((uint64_t)us * (SystemCoreClock / 1000000));
+}
+
+void Delay_Init(void) {}
+
+void Delay_Us(u32 n) {
+    Fake_Clock_Advance_Us(n);
+}
+
+void Delay_Ms(u32 n) {
+    Fake_Clock_Advance((uint64_t)n * (SystemCoreClock / 1000));
+}
+
+void USART_Printf_Init(u32 baudrate) {
+    (void)baudrate;
+}
+
+FlagStatus RNG_GetFlagStatus(u8 flag) {
+    (void)flag;
+    return SET;
+}
+
+u32 RNG_GetRandomNumber(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
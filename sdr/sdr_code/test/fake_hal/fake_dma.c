@@ -0,0 +1,206 @@
+#include <string.h>
+#include "fake_hal.h"
+#include "adc_iq.h"
+#include "dac_stream.h"
+#include "hardware.h"
+
+/* ---- ADC: DMA1 channel 1 circular buffer, filled from the test ---- */
+
+static u32 *adc_buffer;
+static u16 adc_length;
+static u16 adc_position;
+static u32 adc_period;          // cycles per sample pair, 0 while stopped
+static adc_iq_callback_t adc_callback;
+static void *adc_context;
+static u32 adc_blocks;
+
+/* ---- DAC: DMA2 channel 3 circular buffer, played by the clock ---- */
+
+static u32 *dac_buffer;
+static u16 dac_half;
+static dac_stream_fill_t dac_fill;
+static void *dac_context;
+static u8 dac_running;
+static u8 dac_next;             // half that finishes next
+static u32 dac_period;          // cycles per DAC sample, from DAC_Timer_Init
+static uint64_t dac_due;        // cycle at which dac_next finishes
+static u32 *volatile dac_free;
+static u32 dac_blocks;
+static u32 dac_underruns;
+static u32 *capture;
+static u32 capture_capacity;
+static u32 capture_count;
+
+void Fake_DMA_Reset(void) {
+    adc_period = 0;
+    adc_blocks = 0;
+    dac_running = 0;
+    dac_period = 0;
+    dac_free = 0;
+    dac_blocks = 0;
+    dac_underruns = 0;
+    capture = 0;
+    capture_capacity = 0;
+    capture_count = 0;
+}
+
+u32 ADC_IQ_Start(u32 sample_rate, u32 *buffer, u16 length, adc_iq_callback_t callback, void *context) {
+    adc_buffer = buffer;
+    adc_length = length;
+    adc_position = 0;
+    adc_callback = callback;
+    adc_context = context;
+    adc_blocks = 0;
+    /* Same rounding as the TIM3 period */
+    adc_period = SystemCoreClock / sample_rate;
+    return SystemCoreClock / adc_period;
+}
+
+void ADC_IQ_Stop(void) {
+    adc_period = 0;
+}
+
+u32 ADC_IQ_Blocks(void) {
+    return adc_blocks;
+}
+
+u32 Fake_ADC_Rate(void) {
+    return adc_period ? SystemCoreClock / adc_period : 0;
+}
+
+/*********************************************************************
+ * @fn      Fake_ADC_Feed
+ *
+ * @brief   Writes sample pairs where DMA would. Each time a half fills,
+ *          the clock moves on by that half's duration and then the
+ *          callback runs, as from the HT/TC interrupt.
+ *
+ * @return  halves handed to the callback
+ */
+u32 Fake_ADC_Feed(const u32 *samples, u32 count) {
+    u16 half = adc_length / 2;
+    u32 halves = 0;
+
+    for (u32 k = 0; k < count && adc_period; k++) {
+        adc_buffer[adc_position++] = samples[k];
+        if (adc_position == half || adc_position == adc_length) {
+            u32 *done = adc_buffer + adc_position - half;
+
+            if (adc_position == adc_length)
+                adc_position = 0;
+            Fake_Clock_Advance((uint64_t)half * adc_period);
+            adc_callback(done, half, adc_context);
+            adc_blocks++;
+            halves++;
+        }
+    }
+    return halves;
+}
+
+u32 Fake_ADC_Feed_File(const char *path) {
+    FILE *f = fopen(path, "rb");
+    u8 bytes[4 * 256];
+    u32 chunk[256];
+    u32 halves = 0;
+    size_t n;
+
+    if (!f)
+        return 0;
+    while ((n = fread(bytes, 4, 256, f)) > 0) {
+        for (size_t k = 0; k < n; k++)
+            chunk[k] = bytes[4 * k] | (u32)bytes[4 * k + 1] << 8 |
+                       (u32)bytes[4 * k + 2] << 16 | (u32)bytes[4 * k + 3] << 24;
+        halves += Fake_ADC_Feed(chunk, (u32)n);
+    }
+    fclose(f);
+    return halves;
+}
+
+void DAC_Stream_Start(u32 *buffer, u16 length, dac_stream_fill_t fill, void *context) {
+    dac_buffer = buffer;
+    dac_half = length / 2;
+    dac_fill = fill;
+    dac_context = context;
+    dac_free = 0;
+    dac_blocks = 0;
+    dac_underruns = 0;
+
+    if (fill) {
+        fill(buffer, dac_half, context);
+        fill(buffer + dac_half, dac_half, context);
+    } else {
+        for (u16 i = 0; i < length; i++)
+            buffer[i] = DAC_IQ(2048, 2048);
+    }
+    dac_next = 0;
+    dac_due = Fake_Clock_Cycles() + (uint64_t)dac_half * dac_period;
+    dac_running = 1;
+}
+
+void DAC_Stream_Stop(void) {
+    dac_running = 0;
+    dac_free = 0;
+}
+
+u32 *DAC_Stream_Acquire(void) {
+    return dac_free;
+}
+
+void DAC_Stream_Release(u32 *half) {
+    if (dac_free == half)
+        dac_free = 0;
+    dac_blocks++;
+}
+
+u16 DAC_Stream_HalfLength(void) {
+    return dac_half;
+}
+
+u32 DAC_Stream_Blocks(void) {
+    return dac_blocks;
+}
+
+u32 DAC_Stream_Underruns(void) {
+    return dac_underruns;
+}
+
+/* TIM8 update rate: SystemCoreClock / ((arr + 1) * (psc + 1)) */
+void DAC_Timer_Init(u16 arr, u16 psc) {
+    dac_period = (u32)(arr + 1) * (psc + 1);
+    dac_due = Fake_Clock_Cycles() + (uint64_t)dac_half * dac_period;
+}
+
+u32 Fake_DAC_Rate(void) {
+    return dac_period ? SystemCoreClock / dac_period : 0;
+}
+
+void Fake_DAC_Capture(u32 *buffer, u32 capacity) {
+    capture = buffer;
+    capture_capacity = capacity;
+    capture_count = 0;
+}
+
+u32 Fake_DAC_Captured(void) {
+    return capture_count;
+}
+
+/* Clock hook: play out and refill every half finished by now */
+void Fake_DMA_Clock(uint64_t now) {
+    while (dac_running && dac_period && dac_due <= now) {
+        u32 *half = dac_buffer + dac_next * dac_half;
+
+        for (u16 k = 0; k < dac_half && capture_count < capture_capacity; k++)
+            capture[capture_count++] = half[k];
+
+        if (dac_fill) {
+            dac_fill(half, dac_half, dac_context);
+            dac_blocks++;
+        } else {
+            if (dac_free)
+                dac_underruns++;
+            dac_free = half;
+        }
+        dac_next ^= 1;
+        dac_due += (uint64_t)dac_half * dac_period;
+    }
+}
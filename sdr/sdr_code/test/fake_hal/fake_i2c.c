@@ -0,0 +1,150 @@
+#include <string.h>
+#include "fake_hal.h"
+#include "i2c1_queue.h"
+#include "i2c_tx.h"
+
+static fake_i2c_record_t records[FAKE_I2C_RECORDS];
+static u32 count;
+static u32 dropped;
+static u8 registers[128][256];
+
+static fake_i2c_record_t *open_record;  // OLED_I2C_start .. OLED_I2C_stop
+
+void Fake_I2C_Reset(void) {
+    count = 0;
+    dropped = 0;
+    open_record = 0;
+    memset(registers, 0, sizeof(registers));
+}
+
+static fake_i2c_record_t *Fake_I2C_New(u8 bus, u8 address, u8 read) {
+    fake_i2c_record_t *r;
+
+    if (count == FAKE_I2C_RECORDS) {
+        dropped++;
+        return 0;
+    }
+    r = &records[count++];
+    r->bus = bus;
+    r->address = address;
+    r->read = read;
+    r->length = 0;
+    r->cycles = Fake_Clock_Cycles();
+    return r;
+}
+
+static void Fake_I2C_Append(fake_i2c_record_t *r, u8 byte) {
+    if (!r)
+        return;
+    if (r->length < FAKE_I2C_DATA_MAX)
+        r->data[r->length] = byte;
+    r->length++;
+}
+
+u32 Fake_I2C_Count(void) {
+    return count;
+}
+
+const fake_i2c_record_t *Fake_I2C_Record(u32 index) {
+    return index < count ? &records[index] : 0;
+}
+
+void Fake_I2C_Clear(void) {
+    count = 0;
+    open_record = 0;
+}
+
+/* One line per transaction: cycle, bus, address, R/W and the bytes */
+void Fake_I2C_Print(FILE *out) {
+    for (u32 i = 0; i < count; i++) {
+        const fake_i2c_record_t *r = &records[i];
+        u16 shown = r->length < FAKE_I2C_DATA_MAX ? r->length : FAKE_I2C_DATA_MAX;
+
+        fprintf(out, "%10llu I2C%u 0x%02X %c %3u:", (unsigned long long)r->cycles, r->bus,
+                r->address, r->read ? 'R' : 'W', r->length);
+        for (u16 k = 0; k < shown; k++)
+            fprintf(out, " %02X", r->data[k]);
+        fprintf(out, "\n");
+    }
+    if (dropped)
+        fprintf(out, "(%lu transactions not recorded)\n", (unsigned long)dropped);
+}
+
+u8 Fake_I2C_Register(u8 address, u8 reg) {
+    return registers[address & 0x7F][reg];
+}
+
+void Fake_I2C_Set_Register(u8 address, u8 reg, u8 value) {
+    registers[address & 0x7F][reg] = value;
+}
+
+/* ---- I2C1 transaction queue: every transaction completes immediately ---- */
+
+void I2C1_Queue_Init(void) {}
+
+int I2C1_Queue_Write(u8 address, u8 reg, const u8 *buf, u8 len, i2c1_callback_t callback, void *context) {
+    fake_i2c_record_t *r = Fake_I2C_New(FAKE_I2C_BUS_SYNTH, address, 0);
+
+    Fake_I2C_Append(r, reg);
+    for (u8 k = 0; k < len; k++) {
+        Fake_I2C_Append(r, buf[k]);
+        registers[address & 0x7F][(u8)(reg + k)] = buf[k];
+    }
+    if (callback)
+        callback(I2C1_OK, context);
+    return 0;
+}
+
+int I2C1_Queue_Read(u8 address, u8 reg, u8 *dest, u8 len, i2c1_callback_t callback, void *context) {
+    fake_i2c_record_t *r = Fake_I2C_New(FAKE_I2C_BUS_SYNTH, address, 1);
+
+    Fake_I2C_Append(r, reg);
+    for (u8 k = 0; k < len; k++) {
+        dest[k] = registers[address & 0x7F][(u8)(reg + k)];
+        Fake_I2C_Append(r, dest[k]);
+    }
+    if (callback)
+        callback(I2C1_OK, context);
+    return 0;
+}
+
+int I2C1_Queue_Idle(void) {
+    return 1;
+}
+
+void I2C1_Queue_Flush(void) {}
+
+u32 I2C1_Queue_Errors(void) {
+    return 0;
+}
+
+/* ---- OLED I2C2: blocking byte writes and queued sends both land in the log ---- */
+
+void OLED_I2C_init(void) {}
+
+void OLED_I2C_start(uint8_t addr) {
+    open_record = Fake_I2C_New(FAKE_I2C_BUS_OLED, addr, 0);
+}
+
+void OLED_I2C_write(uint8_t data) {
+    Fake_I2C_Append(open_record, data);
+}
+
+void OLED_I2C_stop(void) {
+    open_record = 0;
+}
+
+void OLED_I2C_DMA_init(void) {}
+
+void OLED_I2C_send(uint8_t addr, const uint8_t *buf, uint16_t len) {
+    fake_i2c_record_t *r = Fake_I2C_New(FAKE_I2C_BUS_OLED, addr, 0);
+
+    for (u16 k = 0; k < len; k++)
+        Fake_I2C_Append(r, buf[k]);
+}
+
+int OLED_I2C_busy(void) {
+    return 0;
+}
+
+void OLED_I2C_wait(void) {}
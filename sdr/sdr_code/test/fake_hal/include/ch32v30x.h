@@ -0,0 +1,44 @@
+#pragma once
+
+/*
+	Host stand-in for the WCH peripheral header: the integer types, the few
+	core helpers the portable sources touch, and nothing that maps registers.
+	Peripheral behaviour lives in the fake drivers next to this directory.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef volatile uint8_t vu8;
+typedef volatile uint16_t vu16;
+typedef volatile uint32_t vu32;
+
+typedef enum { RESET = 0, SET = !RESET } FlagStatus, ITStatus;
+typedef enum { DISABLE = 0, ENABLE = !DISABLE } FunctionalState;
+
+typedef enum {
+    DMA1_Channel1_IRQn = 27,
+    DMA1_Channel4_IRQn = 30,
+    TIM4_IRQn = 46,
+    DMA2_Channel3_IRQn = 75,
+} IRQn_Type;
+
+/* SystemCoreClock cycles since Fake_HAL_Reset, the host's mcycle */
+extern u32 SystemCoreClock;
+
+/* Everything runs on one thread, so interrupt masking has nothing to do */
+static inline void NVIC_EnableIRQ(IRQn_Type irq) { (void)irq; }
+static inline void NVIC_DisableIRQ(IRQn_Type irq) { (void)irq; }
+static inline void __enable_irq(void) {}
+static inline void __disable_irq(void) {}
+
+/* RNG: a fixed-seed xorshift so game runs repeat */
+#define RNG_FLAG_DRDY 0x01
+FlagStatus RNG_GetFlagStatus(u8 flag);
+u32 RNG_GetRandomNumber(void);
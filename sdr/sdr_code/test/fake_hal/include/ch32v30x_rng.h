@@ -0,0 +1,3 @@
+#pragma once
+
+#include "ch32v30x.h"
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stdio.h>
+#include "ch32v30x.h"
+
+/* Delays advance the simulated clock instead of waiting */
+void Delay_Init(void);
+void Delay_Us(u32 n);
+void Delay_Ms(u32 n);
+
+/* The debug UART is stdout */
+void USART_Printf_Init(u32 baudrate);
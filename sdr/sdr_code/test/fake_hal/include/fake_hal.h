@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include "ch32v30x.h"
+
+/*
+	Fake HAL for the host-native build (pio test -e native).
+
+	The portable sources in src/ (DSP, synthesizer maths, frame buffer, game,
+	RX chain and audio output) are compiled unchanged for the host. The drivers
+	that touch registers are replaced by the fakes in test/fake_hal:
+
+	  clock   A simulated SystemCoreClock cycle counter. Nothing runs on its
+	          own: Delay_Us/Ms, Fake_Clock_Advance and fed ADC samples move it.
+	  DMA     ADC_IQ_* takes its samples from Fake_ADC_Feed / Fake_ADC_Feed_File
+	          and calls the callback for each completed half, as the HT/TC
+	          interrupt does. DAC_Stream_* plays at the rate set by
+	          DAC_Timer_Init; halves that finish as the clock advances are
+	          captured and refilled.
+	  I2C     I2C1_Queue_* (Si5351) and OLED_I2C_* (display) append every
+	          transaction to one log, complete at once and never fail.
+	  board   Audio amplifier state, posted events and key states.
+
+	Call Fake_HAL_Reset() from setUp() so each test starts from cycle 0 with
+	empty logs.
+*/
+
+void Fake_HAL_Reset(void);
+
+/* ---- clock ---- */
+uint64_t Fake_Clock_Cycles(void);
+void Fake_Clock_Advance(uint64_t cycles);
+void Fake_Clock_Advance_Us(uint32_t us);
+
+/* ---- I2C ---- */
+#define FAKE_I2C_BUS_SYNTH   1      // I2C1: Si5351
+#define FAKE_I2C_BUS_OLED    2      // I2C2: SSD1306
+#define FAKE_I2C_RECORDS     2048
+#define FAKE_I2C_DATA_MAX    1040   // a full frame through OLED_I2C_write plus commands
+
+typedef struct {
+    u8 bus;
+    u8 address;                 // 7 bit
+    u8 read;                    // 1: register read, data holds what was returned
+    u16 length;                 // bytes in the transaction, data keeps up to FAKE_I2C_DATA_MAX
+    u8 data[FAKE_I2C_DATA_MAX]; // I2C1: register then payload; I2C2: the raw bytes
+    uint64_t cycles;            // Fake_Clock_Cycles when it was issued
+} fake_i2c_record_t;
+
+u32 Fake_I2C_Count(void);
+const fake_i2c_record_t *Fake_I2C_Record(u32 index);
+void Fake_I2C_Clear(void);
+void Fake_I2C_Print(FILE *out);
+/* Shadow register file behind I2C1 reads and writes */
+u8 Fake_I2C_Register(u8 address, u8 reg);
+void Fake_I2C_Set_Register(u8 address, u8 reg, u8 value);
+
+/* ---- DMA streams ---- */
+u32 Fake_ADC_Rate(void);                            // 0 while stopped
+u32 Fake_ADC_Feed(const u32 *samples, u32 count);   // packed pairs, returns halves completed
+u32 Fake_ADC_Feed_File(const char *path);           // little-endian packed pairs
+u32 Fake_DAC_Rate(void);
+/* Played DAC words go to buffer (capacity words) until it is full */
+void Fake_DAC_Capture(u32 *buffer, u32 capacity);
+u32 Fake_DAC_Captured(void);
+
+/* ---- board ---- */
+u8 Fake_Amplifier_On(void);
+u32 Fake_Events_Take(void);                         // EVENT_BIT set posted since the last call
+void Fake_Key_Set(u8 key, u8 down);
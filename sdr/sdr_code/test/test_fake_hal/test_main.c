@@ -0,0 +1,104 @@
+/*
+	Fake HAL self tests and the Si5351 driver against recorded I2C:
+	pio test -e native -f test_fake_hal
+*/
+#include <unity.h>
+#include "fake_hal.h"
+#include "debug.h"
+#include "events.h"
+#include "Si5351.h"
+
+#define SI5351 0x60
+
+void setUp(void) {
+	Fake_HAL_Reset();
+	Si5351_InvalidateCache();
+}
+
+void tearDown(void) {}
+
+/* Output frequency from the PLLA registers 26-33 of the register file, N fixed */
+static double si5351_frequency(u32 N) {
+	u8 r[8];
+	u32 p1, p2, p3;
+
+	for (u8 k = 0; k < 8; k++)
+		r[k] = Fake_I2C_Register(SI5351, 26 + k);
+	p3 = (u32)(r[5] & 0xF0) << 12 | (u32)r[0] << 8 | r[1];
+	p1 = (u32)(r[2] & 0x03) << 16 | (u32)r[3] << 8 | r[4];
+	p2 = (u32)(r[5] & 0x0F) << 16 | (u32)r[6] << 8 | r[7];
+	return SI5351_XTAL_FREQ * ((p1 + 512) / 128.0 + p2 / (128.0 * p3)) / N;
+}
+
+static void test_delays_advance_the_clock(void) {
+	TEST_ASSERT_EQUAL_UINT32(0, (u32)Fake_Clock_Cycles());
+	Delay_Us(10);
+	TEST_ASSERT_EQUAL_UINT32(1440, (u32)Fake_Clock_Cycles());
+	Delay_Ms(3);
+	TEST_ASSERT_EQUAL_UINT32(3, Event_Millis());
+}
+
+static void test_events_are_collected(void) {
+	Event_Post(EVENT_SPECTRUM);
+	Event_Post(EVENT_KEY);
+	TEST_ASSERT_EQUAL_HEX32(EVENT_BIT(EVENT_SPECTRUM) | EVENT_BIT(EVENT_KEY), Fake_Events_Take());
+	TEST_ASSERT_EQUAL_HEX32(0, Fake_Events_Take());
+}
+
+static void test_register_read_is_recorded(void) {
+	const fake_i2c_record_t *r;
+
+	Fake_I2C_Set_Register(SI5351, 0, 0x11);
+	TEST_ASSERT_EQUAL_HEX8(0x11, Si5351_ReadRegister(0));
+	TEST_ASSERT_EQUAL_UINT32(1, Fake_I2C_Count());
+	r = Fake_I2C_Record(0);
+	TEST_ASSERT_EQUAL_UINT8(FAKE_I2C_BUS_SYNTH, r->bus);
+	TEST_ASSERT_EQUAL_HEX8(SI5351, r->address);
+	TEST_ASSERT_EQUAL_UINT8(1, r->read);
+}
+
+static void test_first_tune_programs_the_chip(void) {
+	const fake_i2c_record_t *last;
+
+	TEST_ASSERT_EQUAL_INT(0, Si5351_SetFrequency(7074000));
+	TEST_ASSERT_TRUE(Fake_I2C_Count() > 5);
+	for (u32 i = 0; i < Fake_I2C_Count(); i++) {
+		TEST_ASSERT_EQUAL_UINT8(FAKE_I2C_BUS_SYNTH, Fake_I2C_Record(i)->bus);
+		TEST_ASSERT_EQUAL_HEX8(SI5351, Fake_I2C_Record(i)->address);
+	}
+
+	/* Ends by enabling CLK0 and CLK1, after the PLL reset */
+	last = Fake_I2C_Record(Fake_I2C_Count() - 1);
+	TEST_ASSERT_EQUAL_HEX8(3, last->data[0]);
+	TEST_ASSERT_EQUAL_HEX8(0xFC, last->data[1]);
+	TEST_ASSERT_EQUAL_HEX8(0xAC, Fake_I2C_Register(SI5351, 177));
+	TEST_ASSERT_EQUAL_HEX8(0x4F, Fake_I2C_Register(SI5351, 16));
+	TEST_ASSERT_EQUAL_HEX8(0x4F, Fake_I2C_Register(SI5351, 17));
+	TEST_ASSERT_EQUAL_HEX8(86, Fake_I2C_Register(SI5351, 166));
+
+	/* 40 m plan: N = 86, 10 Hz steps */
+	TEST_ASSERT_DOUBLE_WITHIN(10.0, 7074000.0, si5351_frequency(86));
+}
+
+static void test_retune_in_band_only_touches_the_pll(void) {
+	Si5351_SetFrequency(7074000);
+	Fake_I2C_Clear();
+
+	TEST_ASSERT_EQUAL_INT(0, Si5351_SetFrequency(7076500));
+	TEST_ASSERT_TRUE(Fake_I2C_Count() >= 1 && Fake_I2C_Count() <= 2);
+	for (u32 i = 0; i < Fake_I2C_Count(); i++) {
+		const fake_i2c_record_t *r = Fake_I2C_Record(i);
+		TEST_ASSERT_TRUE(r->data[0] >= 26 && r->data[0] + r->length - 1 <= 26 + 8);
+	}
+	TEST_ASSERT_DOUBLE_WITHIN(10.0, 7076500.0, si5351_frequency(86));
+}
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_delays_advance_the_clock);
+	RUN_TEST(test_events_are_collected);
+	RUN_TEST(test_register_read_is_recorded);
+	RUN_TEST(test_first_tune_programs_the_chip);
+	RUN_TEST(test_retune_in_band_only_touches_the_pll);
+	return UNITY_END();
+}
@@ -0,0 +1,136 @@
+/*
+	u8g2 frame buffer, partial refresh and game frames on the fake HAL, with
+	the display traffic taken from the recorded I2C2 transactions.
+	pio test -e native -f test_frame_buffer
+*/
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+#include <u8g2.h>
+#include "fake_hal.h"
+#include "display.h"
+#include "keys.h"
+#include "oled_min.h"
+#include "tiny_invaders.h"
+#include "waterfall.h"
+
+#define WATERFALL_FRAMES 100
+
+static const int16_t QUARTER[4][2] = {{4000, 0}, {0, 4000}, {-4000, 0}, {0, -4000}};
+
+extern u8g2_t u8g2;
+void u8g2_setup(void);
+
+static u32 oled_bytes(void) {
+	u32 bytes = 0;
+
+	for (u32 i = 0; i < Fake_I2C_Count(); i++) {
+		const fake_i2c_record_t *r = Fake_I2C_Record(i);
+		TEST_ASSERT_EQUAL_UINT8(FAKE_I2C_BUS_OLED, r->bus);
+		TEST_ASSERT_EQUAL_HEX8(OLED_ADDR, r->address);
+		bytes += r->length;
+	}
+	return bytes;
+}
+
+/* Display start line of the last 0x40 | line command sent, -1 if none */
+static int oled_start_line(void) {
+	int line = -1;
+
+	for (u32 i = 0; i < Fake_I2C_Count(); i++) {
+		const fake_i2c_record_t *r = Fake_I2C_Record(i);
+		if (r->length == 2 && r->data[0] == 0x00 && (r->data[1] & 0xC0) == 0x40)
+			line = r->data[1] & 0x3F;
+	}
+	return line;
+}
+
+static int buffer_blank(void) {
+	const uint8_t *buf = u8g2_GetBufferPtr(&u8g2);
+
+	for (u16 k = 0; k < DISPLAY_TILE_COLS * DISPLAY_TILE_ROWS * 8; k++) {
+		if (buf[k])
+			return 0;
+	}
+	return 1;
+}
+
+void setUp(void) {
+	Fake_HAL_Reset();
+	u8g2_setup();
+	Display_Invalidate();
+	Fake_I2C_Clear();
+}
+
+void tearDown(void) {}
+
+static void test_full_frame_then_changed_tiles_only(void) {
+	u32 full;
+
+	u8g2_ClearBuffer(&u8g2);
+	TEST_ASSERT_EQUAL_UINT8(DISPLAY_TILE_COLS * DISPLAY_TILE_ROWS, Display_Flush(&u8g2));
+	full = oled_bytes();
+	TEST_ASSERT_TRUE(full >= 1024);
+
+	Fake_I2C_Clear();
+	u8g2_DrawPixel(&u8g2, 10, 10);
+	TEST_ASSERT_EQUAL_UINT8(1, Display_Flush(&u8g2));
+	TEST_ASSERT_TRUE(oled_bytes() > 8 && oled_bytes() < full / 16);
+
+	Fake_I2C_Clear();
+	TEST_ASSERT_EQUAL_UINT8(0, Display_Flush(&u8g2));
+	TEST_ASSERT_EQUAL_UINT32(0, Fake_I2C_Count());
+}
+
+static void test_game_draws_frames(void) {
+	tiny_invaders_setup();
+	for (u16 frame = 0; frame < 2000; frame++) {
+		/* Tap fire now and then to start and play */
+		Fake_Key_Set(KEY_PTT, (frame & 63) < 4);
+		tiny_invaders_loop();
+	}
+	TEST_ASSERT_FALSE(buffer_blank());
+	Display_Flush(&u8g2);
+	TEST_ASSERT_TRUE(Fake_I2C_Count() > 0);
+}
+
+/*
+	The panel scrolls the waterfall (display start line), so a frame sends the
+	two spectrum pages and the page holding the new row: 3 of 8 pages. Shifting
+	the rows in the frame buffer instead changed every tile, about 768 bytes.
+*/
+static void test_waterfall_frame_sends_three_pages(void) {
+	int16_t iq[2 * WATERFALL_FFT_N];
+	u32 bytes = 0, max_tiles = 0;
+	char message[64];
+
+	Waterfall_Init(&u8g2);
+	Display_Flush(&u8g2);
+	for (u16 frame = 1; frame <= WATERFALL_FRAMES; frame++) {
+		/* A carrier at fs/4 over a little noise */
+		for (u16 k = 0; k < WATERFALL_FFT_N; k++) {
+			iq[2 * k] = QUARTER[k & 3][0] + (int16_t)((k * 7919u + frame * 31u) % 64) - 32;
+			iq[2 * k + 1] = QUARTER[k & 3][1] + (int16_t)((k * 104729u + frame * 17u) % 64) - 32;
+		}
+		Waterfall_Update(&u8g2, iq);
+		Fake_I2C_Clear();
+		u8 tiles = Display_Flush(&u8g2);
+		if (tiles > max_tiles)
+			max_tiles = tiles;
+		bytes += oled_bytes();
+		TEST_ASSERT_EQUAL_INT((64 - frame) & 63, oled_start_line());
+	}
+	TEST_ASSERT_TRUE(max_tiles <= 3 * DISPLAY_TILE_COLS);
+	snprintf(message, sizeof(message), "waterfall: %lu bytes per frame, at most %lu tiles",
+	         (unsigned long)(bytes / WATERFALL_FRAMES), (unsigned long)max_tiles);
+	TEST_MESSAGE(message);
+	TEST_ASSERT_TRUE(bytes / WATERFALL_FRAMES < 3 * 128 * 3 / 2);
+}
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_full_frame_then_changed_tiles_only);
+	RUN_TEST(test_game_draws_frames);
+	RUN_TEST(test_waterfall_frame_sends_three_pages);
+	return UNITY_END();
+}
@@ -0,0 +1,376 @@
+/*
+	Golden-vector regression: the vectors from scripts/gen_golden_vectors.py go
+	through the firmware's DSP blocks in the same block sizes as rx.c, and each
+	stage must match the notebook reference to its minimum SNR. The runner also
+	reports each block's throughput.
+
+	pio test -e native -f test_golden_vectors
+
+	Vectors are read from test/golden, or from $GOLDEN_DIR.
+
+	A stage is compared after the best integer lag and a FIT_TAPS complex FIR
+	plus offset fitted by least squares, so gain, delay, DC and gentle
+	passband slope differences from the reference do not count as error.
+	Noise, distortion, images and aliasing do.
+*/
+#include <complex.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unity.h>
+#include "adc_iq.h"
+#include "rx.h"
+#include "decimate.h"
+#include "iq_correct.h"
+#include "fm_demod.h"
+#include "weaver.h"
+
+#define GV_MAX_STAGES 8
+#define FIT_TAPS      5
+#define MAX_LAG       64
+#define RIDGE         1e-6
+#define BENCH_SECONDS 0.1
+
+enum GV_TYPE { GV_ADC = 0, GV_COMPLEX, GV_REAL };
+
+typedef struct {
+	char name[17];
+	uint32_t type, rate, count;
+	float min_snr_db;
+	uint32_t settle;
+	void *data;
+} gv_stage_t;
+
+typedef struct {
+	uint32_t stages;
+	gv_stage_t stage[GV_MAX_STAGES];
+} gv_file_t;
+
+typedef enum { DEMOD_FM, DEMOD_USB } demod_t;
+
+/* Firmware output of every stage for one vector */
+typedef struct {
+	uint32_t pairs;             // decimated I/Q pairs
+	int16_t *baseband;
+	int16_t *corrected;
+	int16_t *audio;
+} chain_out_t;
+
+static gv_file_t vector;
+static chain_out_t out;
+
+static void gv_free(gv_file_t *f) {
+	for (uint32_t s = 0; s < f->stages; s++) {
+		free(f->stage[s].data);
+		f->stage[s].data = NULL;
+	}
+	f->stages = 0;
+}
+
+static int gv_load(const char *name, gv_file_t *f) {
+	const char *dir = getenv("GOLDEN_DIR");
+	char path[256], magic[4];
+	uint32_t version, stages;
+	FILE *file;
+
+	snprintf(path, sizeof(path), "%s/%s", dir ? dir : "test/golden", name);
+	file = fopen(path, "rb");
+	if (!file)
+		return 0;
+	if (fread(magic, 4, 1, file) != 1 || memcmp(magic, "GVEC", 4) ||
+	    fread(&version, 4, 1, file) != 1 || version != 1 ||
+	    fread(&f->stages, 4, 1, file) != 1 || f->stages > GV_MAX_STAGES) {
+		f->stages = 0;
+		fclose(file);
+		return 0;
+	}
+	stages = f->stages;
+
+	/* f->stages counts the stages fully loaded, so gv_free releases exactly those */
+	for (f->stages = 0; f->stages < stages; f->stages++) {
+		gv_stage_t *st = &f->stage[f->stages];
+		size_t size;
+
+		memset(st->name, 0, sizeof(st->name));
+		st->data = NULL;
+		if (fread(st->name, 16, 1, file) != 1 || fread(&st->type, 4, 1, file) != 1 ||
+		    fread(&st->rate, 4, 1, file) != 1 || fread(&st->count, 4, 1, file) != 1 ||
+		    fread(&st->min_snr_db, 4, 1, file) != 1 || fread(&st->settle, 4, 1, file) != 1)
+			break;
+		size = (size_t)st->count * (st->type == GV_COMPLEX ? 8 : 4);
+		st->data = malloc(size);
+		if (!st->data || fread(st->data, 1, size, file) != size) {
+			free(st->data);
+			st->data = NULL;
+			break;
+		}
+	}
+	fclose(file);
+	if (f->stages < stages) {
+		gv_free(f);
+		return 0;
+	}
+	return 1;
+}
+
+static const gv_stage_t *gv_stage(const gv_file_t *f, const char *name) {
+	for (uint32_t s = 0; s < f->stages; s++) {
+		if (!strcmp(f->stage[s].name, name))
+			return &f->stage[s];
+	}
+	return 0;
+}
+
+/* ---- firmware chain, as RX_Process runs it ---- */
+
+static uint32_t run_decimator(const uint32_t *adc, uint32_t count, int16_t *baseband) {
+	static uint32_t half[RX_ADC_HALF];
+	decimator_t decimator;
+	uint32_t pairs = 0;
+
+	decimator_init_default(&decimator);
+	for (uint32_t k = 0; k + RX_ADC_HALF <= count; k += RX_ADC_HALF) {
+		int16_t *iq = (int16_t *)half;
+		uint16_t n;
+
+		memcpy(half, adc + k, sizeof(half));
+		ADC_IQ_Unpack(half, iq, RX_ADC_HALF);
+		n = decimator_process(&decimator, iq, RX_ADC_HALF);
+		memcpy(baseband + 2 * pairs, iq, n * 2 * sizeof(int16_t));
+		pairs += n;
+	}
+	return pairs;
+}
+
+static void run_iq_correct(int16_t *iq, uint32_t pairs) {
+	iq_correct_t correct;
+
+	iq_correct_init(&correct, RX_IQ_DC_SHIFT, RX_IQ_ADAPT_SHIFT);
+	for (uint32_t k = 0; k < pairs; k += RX_BLOCK)
+		iq_correct_process(&correct, iq + 2 * k, pairs - k < RX_BLOCK ? pairs - k : RX_BLOCK);
+}
+
+static void run_demod(demod_t demod, int16_t *iq, int16_t *audio, uint32_t pairs) {
+	static fm_demod_t fm;
+	static weaver_t weaver;
+
+	if (demod == DEMOD_FM)
+		fm_demod_init(&fm, RX_AUDIO_RATE, RX_FM_DEVIATION, RX_FM_DEEMPH_US);
+	else
+		weaver_init(&weaver, RX_AUDIO_RATE, WEAVER_USB_CENTRE_MHZ, WEAVER_SSB_TAPS);
+	for (uint32_t k = 0; k < pairs; k += RX_BLOCK) {
+		uint16_t n = pairs - k < RX_BLOCK ? pairs - k : RX_BLOCK;
+
+		if (demod == DEMOD_FM)
+			fm_demod_process(&fm, iq + 2 * k, audio + k, n);
+		else
+			weaver_process(&weaver, iq + 2 * k, audio + k, n);
+	}
+}
+
+static void run_chain(const gv_stage_t *adc, demod_t demod) {
+	uint32_t max_pairs = adc->count / (RX_ADC_RATE / RX_AUDIO_RATE) + 1;
+	int16_t *scratch;
+
+	out.baseband = malloc(max_pairs * 2 * sizeof(int16_t));
+	out.corrected = malloc(max_pairs * 2 * sizeof(int16_t));
+	out.audio = malloc(max_pairs * sizeof(int16_t));
+
+	out.pairs = run_decimator(adc->data, adc->count, out.baseband);
+	memcpy(out.corrected, out.baseband, out.pairs * 2 * sizeof(int16_t));
+	run_iq_correct(out.corrected, out.pairs);
+
+	/* The Weaver demodulator works in place */
+	scratch = malloc(out.pairs * 2 * sizeof(int16_t));
+	memcpy(scratch, out.corrected, out.pairs * 2 * sizeof(int16_t));
+	run_demod(demod, scratch, out.audio, out.pairs);
+	free(scratch);
+}
+
+/* ---- comparison ---- */
+
+static double complex ref_at(const gv_stage_t *ref, int32_t k) {
+	if (k < 0 || (uint32_t)k >= ref->count)
+		return 0;
+	if (ref->type == GV_COMPLEX)
+		return ((float *)ref->data)[2 * k] + I * ((float *)ref->data)[2 * k + 1];
+	return ((float *)ref->data)[k];
+}
+
+static double complex out_at(const int16_t *y, int complex_out, uint32_t k) {
+	return complex_out ? y[2 * k] + I * y[2 * k + 1] : y[k];
+}
+
+/* Solve the n x n system a x = b in place, partial pivoting */
+static void solve(double complex *a, double complex *b, int n) {
+	for (int c = 0; c < n; c++) {
+		int p = c;
+		for (int r = c + 1; r < n; r++) {
+			if (cabs(a[r * n + c]) > cabs(a[p * n + c]))
+				p = r;
+		}
+		for (int k = 0; k < n; k++) {
+			double complex t = a[c * n + k];
+			a[c * n + k] = a[p * n + k];
+			a[p * n + k] = t;
+		}
+		double complex t = b[c];
+		b[c] = b[p];
+		b[p] = t;
+		for (int r = c + 1; r < n; r++) {
+			double complex f = a[r * n + c] / a[c * n + c];
+			for (int k = c; k < n; k++)
+				a[r * n + k] -= f * a[c * n + k];
+			b[r] -= f * b[c];
+		}
+	}
+	for (int r = n - 1; r >= 0; r--) {
+		for (int k = r + 1; k < n; k++)
+			b[r] -= a[r * n + k] * b[k];
+		b[r] /= a[r * n + r];
+	}
+}
+
+/*
+	SNR in dB of firmware output y (pairs or samples) against stage ref: fitted
+	signal power over the power of what the fit leaves
+*/
+static double stage_snr(const gv_stage_t *ref, const int16_t *y, uint32_t count) {
+	enum { N = FIT_TAPS + 1 };
+	int complex_out = ref->type == GV_COMPLEX;
+	uint32_t first = ref->settle, last = (count < ref->count ? count : ref->count) - MAX_LAG - FIT_TAPS;
+	double complex a[N * N] = {0}, b[N] = {0}, basis[N];
+	double best = -1, signal = 0, error = 0;
+	int32_t lag = 0;
+
+	for (int32_t l = -MAX_LAG; l <= MAX_LAG; l++) {
+		double complex c = 0;
+		for (uint32_t k = first; k < last; k++)
+			c += out_at(y, complex_out, k) * conj(ref_at(ref, (int32_t)k - l));
+		if (cabs(c) > best) {
+			best = cabs(c);
+			lag = l;
+		}
+	}
+
+	for (uint32_t k = first; k < last; k++) {
+		double complex v = out_at(y, complex_out, k);
+		for (int j = 0; j < FIT_TAPS; j++)
+			basis[j] = ref_at(ref, (int32_t)k - lag - j + FIT_TAPS / 2);
+		basis[FIT_TAPS] = 1;
+		for (int r = 0; r < N; r++) {
+			for (int c = 0; c < N; c++)
+				a[r * N + c] += conj(basis[r]) * basis[c];
+			b[r] += conj(basis[r]) * v;
+		}
+	}
+	/* A tone makes the shifted taps nearly collinear: a little ridge keeps the fit sane */
+	for (int r = 0; r < FIT_TAPS; r++)
+		a[r * N + r] += RIDGE * creal(a[0]);
+	solve(a, b, N);
+
+	for (uint32_t k = first; k < last; k++) {
+		double complex fit = 0;
+		for (int j = 0; j < FIT_TAPS; j++)
+			fit += b[j] * ref_at(ref, (int32_t)k - lag - j + FIT_TAPS / 2);
+		signal += creal(fit * conj(fit));
+		fit += b[FIT_TAPS];
+		error += creal((out_at(y, complex_out, k) - fit) * conj(out_at(y, complex_out, k) - fit));
+	}
+	return 10 * log10(signal / (error > 0 ? error : 1e-30));
+}
+
+static void check_stage(const char *name, const int16_t *y) {
+	const gv_stage_t *ref = gv_stage(&vector, name);
+	char message[96];
+	double snr;
+
+	TEST_ASSERT_NOT_NULL(ref);
+	snr = stage_snr(ref, y, out.pairs);
+	snprintf(message, sizeof(message), "%-10s SNR %5.1f dB (min %.0f)", name, snr, ref->min_snr_db);
+	TEST_MESSAGE(message);
+	TEST_ASSERT_TRUE_MESSAGE(snr >= ref->min_snr_db, message);
+}
+
+/* ---- throughput ---- */
+
+static double seconds_since(clock_t start) {
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void report_throughput(const gv_stage_t *adc, demod_t demod) {
+	int16_t *scratch = malloc(out.pairs * 2 * sizeof(int16_t));
+	char message[96];
+	uint32_t runs;
+	clock_t start;
+
+	start = clock();
+	for (runs = 0; seconds_since(start) < BENCH_SECONDS; runs++)
+		run_decimator(adc->data, adc->count, scratch);
+	snprintf(message, sizeof(message), "decimator  %6.2f Msample/s in",
+	         (double)runs * adc->count / seconds_since(start) / 1e6);
+	TEST_MESSAGE(message);
+
+	start = clock();
+	for (runs = 0; seconds_since(start) < BENCH_SECONDS; runs++) {
+		memcpy(scratch, out.baseband, out.pairs * 2 * sizeof(int16_t));
+		run_iq_correct(scratch, out.pairs);
+	}
+	snprintf(message, sizeof(message), "iq_correct %6.2f Msample/s in",
+	         (double)runs * out.pairs / seconds_since(start) / 1e6);
+	TEST_MESSAGE(message);
+
+	start = clock();
+	for (runs = 0; seconds_since(start) < BENCH_SECONDS; runs++) {
+		memcpy(scratch, out.corrected, out.pairs * 2 * sizeof(int16_t));
+		run_demod(demod, scratch, out.audio, out.pairs);
+	}
+	snprintf(message, sizeof(message), "%-10s %6.2f Msample/s in", demod == DEMOD_FM ? "fm_demod" : "weaver",
+	         (double)runs * out.pairs / seconds_since(start) / 1e6);
+	TEST_MESSAGE(message);
+	free(scratch);
+}
+
+static void run_vector(const char *name, demod_t demod) {
+	const gv_stage_t *adc;
+
+	if (!gv_load(name, &vector))
+		TEST_FAIL_MESSAGE("vector missing or truncated: python3 scripts/gen_golden_vectors.py test/golden");
+	adc = gv_stage(&vector, "adc");
+	TEST_ASSERT_NOT_NULL(adc);
+	TEST_ASSERT_EQUAL_UINT32(RX_ADC_RATE, adc->rate);
+
+	run_chain(adc, demod);
+	check_stage("baseband", out.baseband);
+	check_stage("corrected", out.corrected);
+	check_stage("audio", out.audio);
+	report_throughput(adc, demod);
+}
+
+void setUp(void) {
+	memset(&out, 0, sizeof(out));
+}
+
+void tearDown(void) {
+	free(out.baseband);
+	free(out.corrected);
+	free(out.audio);
+	gv_free(&vector);
+}
+
+static void test_fm_tone(void) {
+	run_vector("fm_tone.gv", DEMOD_FM);
+}
+
+static void test_usb_tone(void) {
+	run_vector("usb_tone.gv", DEMOD_USB);
+}
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_fm_tone);
+	RUN_TEST(test_usb_tone);
+	return UNITY_END();
+}
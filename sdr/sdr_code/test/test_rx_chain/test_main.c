@@ -0,0 +1,116 @@
+/*
+	The receive chain end to end on the fake HAL: a tone recorded as packed ADC
+	words goes in through DMA, audio comes out of the DAC stream.
+	pio test -e native -f test_rx_chain
+*/
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+#include <unity.h>
+#include "fake_hal.h"
+#include "events.h"
+#include "rx.h"
+#include "audio_out.h"
+
+#define SECONDS      2
+#define SETTLE       (AUDIO_RATE / 2)       // AGC and ring fill, DAC samples
+#define ADC_FILE     "test_rx_chain_adc.bin"
+
+static u32 played[(SECONDS + 1) * AUDIO_RATE];
+
+void setUp(void) {
+	Fake_HAL_Reset();
+	Fake_DAC_Capture(played, sizeof(played) / sizeof(played[0]));
+}
+
+void tearDown(void) {
+	RX_Stop();
+	remove(ADC_FILE);
+}
+
+/* Complex tone offset_hz from the tuned frequency, 12 bit I/Q as the ADCs see it */
+static void write_tone(const char *path, u32 rate, double offset_hz, double amplitude) {
+	FILE *f = fopen(path, "wb");
+
+	TEST_ASSERT_NOT_NULL(f);
+	for (u32 k = 0; k < SECONDS * rate; k++) {
+		double w = 2 * M_PI * offset_hz * k / rate;
+		u32 i = (u32)lround(2048 + amplitude * cos(w));
+		u32 q = (u32)lround(2048 + amplitude * sin(w));
+		u32 word = q << 16 | i;
+		u8 bytes[4] = { word, word >> 8, word >> 16, word >> 24 };
+		fwrite(bytes, 4, 1, f);
+	}
+	fclose(f);
+}
+
+/*
+	Share of the AC power of the played I channel at hz, in 100 ms windows so
+	the resampler's small rate trim does not smear the tone across bins
+*/
+static double tone_fraction(u32 first, u32 count, double hz) {
+	const u32 window = AUDIO_RATE / 10;
+	double fraction = 0;
+	u32 windows = 0;
+
+	for (u32 start = first; start + window <= first + count; start += window, windows++) {
+		double mean = 0, total = 0, re = 0, im = 0;
+
+		for (u32 k = start; k < start + window; k++)
+			mean += (double)(played[k] & 0xFFF);
+		mean /= window;
+		for (u32 k = start; k < start + window; k++) {
+			double x = (double)(played[k] & 0xFFF) - mean;
+			total += x * x;
+			re += x * cos(2 * M_PI * hz * k / AUDIO_RATE);
+			im += x * sin(2 * M_PI * hz * k / AUDIO_RATE);
+		}
+		fraction += total > 0 ? 2 * (re * re + im * im) / window / total : 0;
+	}
+	return windows ? fraction / windows : 0;
+}
+
+static void test_usb_tone_reaches_the_dac(void) {
+	char message[80];
+	clock_t start;
+	double seconds;
+	u32 halves;
+
+	RX_Set_Mode(RX_MODE_USB);
+	RX_Start();
+	TEST_ASSERT_EQUAL_UINT32(AUDIO_RATE, Fake_DAC_Rate());
+	write_tone(ADC_FILE, Fake_ADC_Rate(), 1000, 400);
+
+	start = clock();
+	halves = Fake_ADC_Feed_File(ADC_FILE);
+	seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	/* Simulated time followed the ADC: SECONDS of samples, whole halves only */
+	TEST_ASSERT_EQUAL_UINT32(SECONDS * Fake_ADC_Rate() / RX_ADC_HALF, halves);
+	TEST_ASSERT_DOUBLE_WITHIN(0.01, SECONDS, (double)Fake_Clock_Cycles() / SystemCoreClock);
+
+	TEST_ASSERT_TRUE(Fake_DAC_Captured() > SECONDS * AUDIO_RATE - AUDIO_DAC_LENGTH);
+	TEST_ASSERT_TRUE(Fake_Amplifier_On());
+	TEST_ASSERT_EQUAL_UINT32(0, Audio_Overruns());
+	TEST_ASSERT_TRUE(tone_fraction(SETTLE, Fake_DAC_Captured() - SETTLE, 1000) > 0.98);
+
+	snprintf(message, sizeof(message), "RX chain: %.1f Msample/s at the ADC rate (%.0fx real time)",
+	         halves * RX_ADC_HALF / seconds / 1e6, SECONDS / seconds);
+	TEST_MESSAGE(message);
+}
+
+static void test_spectrum_block_is_posted(void) {
+	RX_Start();
+	write_tone(ADC_FILE, Fake_ADC_Rate(), 1000, 400);
+	RX_Spectrum_Request();
+	Fake_ADC_Feed_File(ADC_FILE);
+	TEST_ASSERT_TRUE(Fake_Events_Take() & EVENT_BIT(EVENT_SPECTRUM));
+	TEST_ASSERT_NOT_NULL(RX_Spectrum_Block());
+}
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_usb_tone_reaches_the_dac);
+	RUN_TEST(test_spectrum_block_is_posted);
+	return UNITY_END();
+}
@@ -0,0 +1,157 @@
+/*
+	Host tests for include/spsc_ring.h:  pio test -e native
+*/
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <unity.h>
+#include "spsc_ring.h"
+
+#define CAPACITY 8
+
+static spsc_ring_t ring;
+static int slots[CAPACITY];
+
+void setUp(void) {
+	spsc_init(&ring, CAPACITY);
+	memset(slots, 0, sizeof(slots));
+}
+
+void tearDown(void) {}
+
+static void test_empty(void) {
+	uint32_t index;
+
+	TEST_ASSERT_EQUAL_UINT32(0, spsc_count(&ring));
+	TEST_ASSERT_EQUAL_UINT32(CAPACITY, spsc_space(&ring));
+	TEST_ASSERT_EQUAL_UINT32(0, spsc_read_span(&ring, &index));
+	TEST_ASSERT_EQUAL_INT32(-1, spsc_pop_index(&ring));
+}
+
+static void test_push_pop_order(void) {
+	for (int v = 0; v < 5; v++) {
+		int32_t i = spsc_push_index(&ring);
+		TEST_ASSERT_TRUE(i >= 0);
+		slots[i] = v;
+		spsc_commit(&ring, 1);
+	}
+	TEST_ASSERT_EQUAL_UINT32(5, spsc_count(&ring));
+	for (int v = 0; v < 5; v++) {
+		int32_t i = spsc_pop_index(&ring);
+		TEST_ASSERT_TRUE(i >= 0);
+		TEST_ASSERT_EQUAL_INT(v, slots[i]);
+		spsc_release(&ring, 1);
+	}
+	TEST_ASSERT_EQUAL_INT32(-1, spsc_pop_index(&ring));
+}
+
+static void test_full_uses_every_slot(void) {
+	for (int v = 0; v < CAPACITY; v++) {
+		int32_t i = spsc_push_index(&ring);
+		TEST_ASSERT_TRUE(i >= 0);
+		spsc_commit(&ring, 1);
+	}
+	TEST_ASSERT_EQUAL_UINT32(0, spsc_space(&ring));
+	TEST_ASSERT_EQUAL_INT32(-1, spsc_push_index(&ring));
+}
+
+static void test_spans_stop_at_wrap(void) {
+	uint32_t index, n;
+
+	/* Move both indices to 6 so the free space wraps */
+	spsc_commit(&ring, 6);
+	spsc_release(&ring, 6);
+
+	n = spsc_write_span(&ring, &index);
+	TEST_ASSERT_EQUAL_UINT32(6, index);
+	TEST_ASSERT_EQUAL_UINT32(2, n);
+	slots[6] = 60;
+	slots[7] = 70;
+	spsc_commit(&ring, n);
+
+	n = spsc_write_span(&ring, &index);
+	TEST_ASSERT_EQUAL_UINT32(0, index);
+	TEST_ASSERT_EQUAL_UINT32(6, n);
+	slots[0] = 80;
+	spsc_commit(&ring, 1);
+
+	n = spsc_read_span(&ring, &index);
+	TEST_ASSERT_EQUAL_UINT32(6, index);
+	TEST_ASSERT_EQUAL_UINT32(2, n);
+	TEST_ASSERT_EQUAL_INT(60, slots[index]);
+	spsc_release(&ring, n);
+
+	n = spsc_read_span(&ring, &index);
+	TEST_ASSERT_EQUAL_UINT32(0, index);
+	TEST_ASSERT_EQUAL_UINT32(1, n);
+	TEST_ASSERT_EQUAL_INT(80, slots[index]);
+	spsc_release(&ring, n);
+	TEST_ASSERT_EQUAL_UINT32(0, spsc_count(&ring));
+}
+
+static void test_counter_wraparound(void) {
+	/* Free-running indices crossing 2^32 */
+	ring.head = ring.tail = 0xFFFFFFFEu;
+	for (int v = 0; v < 4; v++) {
+		int32_t i = spsc_push_index(&ring);
+		slots[i] = v;
+		spsc_commit(&ring, 1);
+	}
+	TEST_ASSERT_EQUAL_UINT32(4, spsc_count(&ring));
+	for (int v = 0; v < 4; v++) {
+		int32_t i = spsc_pop_index(&ring);
+		TEST_ASSERT_EQUAL_INT(v, slots[i]);
+		spsc_release(&ring, 1);
+	}
+}
+
+/* A producer thread against this consumer: every value arrives once, in order */
+#define STREAM_LENGTH 200000
+
+static spsc_ring_t stream;
+static uint32_t stream_slots[64];
+
+static void *producer(void *arg) {
+	uint32_t next = 0;
+
+	(void)arg;
+	while (next < STREAM_LENGTH) {
+		uint32_t index, k, n = spsc_write_span(&stream, &index);
+		for (k = 0; k < n && next < STREAM_LENGTH; k++)
+			stream_slots[index + k] = next++;
+		spsc_commit(&stream, k);
+		if (!n)
+			sched_yield();
+	}
+	return 0;
+}
+
+static void test_threaded_stream(void) {
+	pthread_t thread;
+	uint32_t expect = 0;
+
+	spsc_init(&stream, 64);
+	pthread_create(&thread, 0, producer, 0);
+	while (expect < STREAM_LENGTH) {
+		uint32_t index, n = spsc_read_span(&stream, &index);
+		for (uint32_t k = 0; k < n; k++, expect++) {
+			if (stream_slots[index + k] != expect)
+				TEST_FAIL_MESSAGE("out of order or corrupted");
+		}
+		spsc_release(&stream, n);
+		if (!n)
+			sched_yield();
+	}
+	pthread_join(thread, 0);
+}
+
+int main(void) {
+	UNITY_BEGIN();
+	RUN_TEST(test_empty);
+	RUN_TEST(test_push_pop_order);
+	RUN_TEST(test_full_uses_every_slot);
+	RUN_TEST(test_spans_stop_at_wrap);
+	RUN_TEST(test_counter_wraparound);
+	RUN_TEST(test_threaded_stream);
+	return UNITY_END();
+}